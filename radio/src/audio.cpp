@@ -372,6 +372,70 @@ void getLogicalSwitchAudioFile(char * filename, int index, unsigned int event)
   strcat(str, SOUNDS_EXT);
 }
 
+// All the files a model may play are numbered: flight modes first, then
+// switches and logical switches, the order in which they used to be searched
+constexpr unsigned int MODEL_FLIGHTMODE_AUDIO_FILES = MAX_FLIGHT_MODES * 2;
+constexpr unsigned int MODEL_SWITCH_AUDIO_FILES = SWSRC_LAST_SWITCH + NUM_XPOTS * XPOTS_MULTIPOS_COUNT - SWSRC_FIRST_SWITCH + 1;
+constexpr unsigned int MODEL_LOGICAL_SWITCH_AUDIO_FILES = MAX_LOGICAL_SWITCHES * 2;
+constexpr unsigned int MODEL_AUDIO_FILES = MODEL_FLIGHTMODE_AUDIO_FILES + MODEL_SWITCH_AUDIO_FILES + MODEL_LOGICAL_SWITCH_AUDIO_FILES;
+
+static void getModelAudioFile(char * filename, unsigned int id)
+{
+  if (id < MODEL_FLIGHTMODE_AUDIO_FILES) {
+    getFlightmodeAudioFile(filename, id / 2, id % 2);
+    return;
+  }
+  id -= MODEL_FLIGHTMODE_AUDIO_FILES;
+
+  if (id < MODEL_SWITCH_AUDIO_FILES) {
+    getSwitchAudioFile(filename, SWSRC_FIRST_SWITCH + id);
+    return;
+  }
+  id -= MODEL_SWITCH_AUDIO_FILES;
+
+  getLogicalSwitchAudioFile(filename, id / 2, id % 2);
+}
+
+static void setModelAudioFileAvailable(unsigned int id)
+{
+  if (id < MODEL_FLIGHTMODE_AUDIO_FILES) {
+    sdAvailableFlightmodeAudioFiles.setBit(INDEX_PHASE_AUDIO_FILE(id / 2, id % 2));
+    return;
+  }
+  id -= MODEL_FLIGHTMODE_AUDIO_FILES;
+
+  if (id < MODEL_SWITCH_AUDIO_FILES) {
+    sdAvailableSwitchAudioFiles.setBit(id);
+    return;
+  }
+  id -= MODEL_SWITCH_AUDIO_FILES;
+
+  sdAvailableLogicalSwitchAudioFiles.setBit(INDEX_LOGICAL_SWITCH_AUDIO_FILE(id / 2, id % 2));
+}
+
+// Case insensitive FNV-1a, folded to 16 bits
+static uint16_t hashAudioFilename(const char * name)
+{
+  uint32_t hash = 2166136261u;
+  while (*name) {
+    uint8_t c = *name++;
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    hash ^= c;
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 16);
+}
+
+struct AudioFileHash {
+  uint16_t hash;
+  uint16_t id;
+};
+
+// The names of the files the model may play are hashed once and sorted,
+// so that each file of the model directory only costs a binary search
+// instead of building and comparing every name. A hash match is confirmed
+// by comparing the names, and the lowest id wins as with a linear search.
 void referenceModelAudioFiles()
 {
   char path[AUDIO_FILENAME_MAXLEN+1];
@@ -387,52 +451,43 @@ void referenceModelAudioFiles()
 
   FRESULT res = f_opendir(&dir, path);        /* Open the directory */
   if (res == FR_OK) {
+    AudioFileHash hashes[MODEL_AUDIO_FILES];
+    for (unsigned int id = 0; id < MODEL_AUDIO_FILES; id++) {
+      getModelAudioFile(path, id);
+      uint16_t hash = hashAudioFilename(filename);
+      // insertion sort, ids stay in order for a same hash
+      unsigned int pos = id;
+      for (; pos > 0 && hashes[pos - 1].hash > hash; pos--) {
+        hashes[pos] = hashes[pos - 1];
+      }
+      hashes[pos] = {hash, (uint16_t)id};
+    }
+
     for (;;) {
       res = f_readdir(&dir, &fno);                   /* Read a directory item */
       if (res != FR_OK || fno.fname[0] == 0) break;  /* Break on error or end of dir */
       uint8_t len = strlen(fno.fname);
-      bool found = false;
 
       // Eliminates directories / non wav files
       if (len < 5 || strcasecmp(fno.fname+len-4, SOUNDS_EXT) || (fno.fattrib & AM_DIR)) continue;
       TRACE("referenceModelAudioFiles(): using file: %s", fno.fname);
 
-      // Flight modes Audio Files <flightmodename>-[on|off].wav
-      for (int i=0; i<MAX_FLIGHT_MODES && !found; i++) {
-        for (int event=0; event<2; event++) {
-          getFlightmodeAudioFile(path, i, event);
-          // TRACE("referenceModelAudioFiles(): searching for %s in %s", filename, fno.fname);
-          if (!strcasecmp(filename, fno.fname)) {
-            sdAvailableFlightmodeAudioFiles.setBit(INDEX_PHASE_AUDIO_FILE(i, event));
-            found = true;
-            TRACE("\tfound: %s", filename);
-            break;
-          }
-        }
+      uint16_t hash = hashAudioFilename(fno.fname);
+      unsigned int first = 0, last = MODEL_AUDIO_FILES;
+      while (first < last) {
+        unsigned int middle = (first + last) / 2;
+        if (hashes[middle].hash < hash)
+          first = middle + 1;
+        else
+          last = middle;
       }
 
-      // Switches Audio Files <switchname>-[up|mid|down].wav
-      for (int i=SWSRC_FIRST_SWITCH; i<=SWSRC_LAST_SWITCH+NUM_XPOTS*XPOTS_MULTIPOS_COUNT && !found; i++) {
-        getSwitchAudioFile(path, i);
-        // TRACE("referenceModelAudioFiles(): searching for %s in %s (%d)", path, fno.fname, i);
+      for (; first < MODEL_AUDIO_FILES && hashes[first].hash == hash; first++) {
+        getModelAudioFile(path, hashes[first].id);
         if (!strcasecmp(filename, fno.fname)) {
-          sdAvailableSwitchAudioFiles.setBit(i-SWSRC_FIRST_SWITCH);
-          found = true;
+          setModelAudioFileAvailable(hashes[first].id);
           TRACE("\tfound: %s", filename);
-        }
-      }
-
-      // Logical Switches Audio Files <switchname>-[on|off].wav
-      for (int i=0; i<MAX_LOGICAL_SWITCHES && !found; i++) {
-        for (int event=0; event<2; event++) {
-          getLogicalSwitchAudioFile(path, i, event);
-          // TRACE("referenceModelAudioFiles(): searching for %s in %s", filename, fno.fname);
-          if (!strcasecmp(filename, fno.fname)) {
-            sdAvailableLogicalSwitchAudioFiles.setBit(INDEX_LOGICAL_SWITCH_AUDIO_FILE(i, event));
-            found = true;
-            TRACE("\tfound: %s", filename);
-            break;
-          }
+          break;
         }
       }
     }
@@ -856,6 +856,9 @@ int cliStackInfo(const char ** argv)
   cliSerialPrint("[MIXER] %d available / %d bytes", mixerStack.available()*4, mixerStack.size());
   cliSerialPrint("[AUDIO] %d available / %d bytes", audioStack.available()*4, audioStack.size());
   cliSerialPrint("[CLI] %d available / %d bytes", cliStack.available()*4, cliStack.size());
+#if defined(STORAGE_TASK)
+  cliSerialPrint("[STORAGE] %d available / %d bytes", storageStack.available()*4, storageStack.size());
+#endif
   return 0;
 }
 
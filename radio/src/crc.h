@@ -24,6 +24,12 @@
 
 #include <inttypes.h>
 
+// Slicing-by-4 costs about 4.5KB of extra tables, only
+// worth it where flash is not scarce
+#if !defined(BOOT) && (defined(STM32F4) || defined(SIMU))
+  #define CRC_SLICING
+#endif
+
 enum {
   CRC_1021,
   CRC_1189,
@@ -628,6 +628,11 @@ PACK(struct PartialModel {
   TimerData timers[MAX_TIMERS];
 });
 
+PACK(struct PartialModelRf {
+  ModelHeader header;
+  ModuleData moduleData[NUM_MODULES];
+});
+
 PACK(struct ModelData {
   CUST_ATTR(semver,nullptr,w_semver);
   ModelHeader header;
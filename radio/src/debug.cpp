@@ -237,6 +237,8 @@ const char * const debugTimerNames[DEBUG_TIMERS_COUNT] = {
   ,"Audio int. "   // debugTimerAudioIterval
   ,"Audio dur. "   // debugTimerAudioDuration
   ," A. consume"   // debugTimerAudioConsume,
+  ,"Stor. copy "   // debugTimerStorageCopy,
+  ,"Stor. write"   // debugTimerStorageWrite,
 
 };
 
@@ -390,6 +390,9 @@ enum DebugTimers {
   debugTimerAudioDuration,
   debugTimerAudioConsume,
 
+  debugTimerStorageCopy,
+  debugTimerStorageWrite,
+
   DEBUG_TIMERS_COUNT
 };
 
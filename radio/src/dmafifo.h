@@ -22,6 +22,7 @@
 #ifndef _DMA_FIFO_H_
 #define _DMA_FIFO_H_
 
+#include <string.h>
 #include "definitions.h"
 
 template <int N>
@@ -69,6 +70,24 @@ class DMAFifo
       }
     }
 
+    // Pops up to 'len' bytes, in at most 2 contiguous copies.
+    // Returns the number of bytes actually popped.
+    uint32_t pop(uint8_t * data, uint32_t len)
+    {
+#if defined(SIMU)
+      return 0;
+#endif
+      uint32_t r = ridx;
+      uint32_t count = (N + (N - stream->NDTR) - r) & (N - 1);
+      if (len < count) count = len;
+      uint32_t first = N - r;
+      if (first > count) first = count;
+      memcpy(data, &fifo[r], first);
+      memcpy(data + first, &fifo[0], count - first);
+      ridx = (r + count) & (N - 1);
+      return count;
+    }
+
     uint8_t * buffer()
     {
       return fifo;
@@ -23,6 +23,7 @@
 #define _FIFO_H_
 
 #include <inttypes.h>
+#include <string.h>
 
 template <class T, int N>
 class Fifo
@@ -50,6 +51,36 @@ class Fifo
       }
     }
 
+    // Pushes up to 'len' elements, in at most 2 contiguous copies.
+    // Returns the number of elements actually pushed.
+    uint32_t push(const T * data, uint32_t len)
+    {
+      uint32_t w = widx;
+      uint32_t count = N - 1 - ((N + w - ridx) & (N - 1));
+      if (len < count) count = len;
+      uint32_t first = N - w;
+      if (first > count) first = count;
+      memcpy(&fifo[w], data, first * sizeof(T));
+      memcpy(&fifo[0], data + first, (count - first) * sizeof(T));
+      widx = (w + count) & (N - 1);
+      return count;
+    }
+
+    // Pops up to 'len' elements, in at most 2 contiguous copies.
+    // Returns the number of elements actually popped.
+    uint32_t pop(T * data, uint32_t len)
+    {
+      uint32_t r = ridx;
+      uint32_t count = (N + widx - r) & (N - 1);
+      if (len < count) count = len;
+      uint32_t first = N - r;
+      if (first > count) first = count;
+      memcpy(data, &fifo[r], first * sizeof(T));
+      memcpy(data + first, &fifo[0], (count - first) * sizeof(T));
+      ridx = (r + count) & (N - 1);
+      return count;
+    }
+
     void skip()
     {
       ridx = nextIndex(ridx);
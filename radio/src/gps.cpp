@@ -44,8 +44,10 @@ gpsdata_t gpsData;
 
 /* This is a light implementation of a GPS frame decoding
    This should work with most of modern GPS devices configured to output 5 frames.
-   It assumes there are some NMEA GGA frames to decode on the serial bus
-   Now verifies checksum correctly before applying data
+   It decodes NMEA GGA and RMC sentences, and u-blox UBX NAV-PVT messages
+   when the receiver is configured to output them.
+   NMEA sentences are buffered whole, checksum verified, then their fields
+   are parsed in place.
 
    Here we use only the following data :
      - latitude
@@ -57,10 +59,6 @@ gpsdata_t gpsData;
      - GPS speed (for OSD displaying)
 */
 
-#define NO_FRAME   0
-#define FRAME_GGA  1
-#define FRAME_RMC  2
-
 #define DIGIT_TO_VAL(_x)    (_x - '0')
 
 uint32_t GPS_coord_to_degrees(const char * coordinateString)
@@ -104,212 +102,367 @@ uint32_t GPS_coord_to_degrees(const char * coordinateString)
   return degrees * 1000000UL + (minutes * 100000UL + fractionalMinutes * 10UL) / 6;
 }
 
-// helper functions
-uint32_t grab_fields(char * src, uint8_t mult)
+// Parses a decimal field in place, keeping 'decimals' fractional digits
+// (truncated). The field ends at the first character which is not a digit
+// or the decimal point, so ',' and '*' terminate it.
+static uint32_t nmeaParseDecimal(const char * field, uint8_t decimals)
 {
-  uint32_t i;
-  uint32_t tmp = 0;
-  for (i = 0; src[i] != 0; i++) {
-    if (src[i] == '.') {
-      i++;
-      if (mult == 0)
-        break;
-      else
-        src[i + mult] = 0;
+  uint32_t value = 0;
+  bool fraction = false;
+  for (; ; field++) {
+    if (*field == '.' && !fraction) {
+      fraction = true;
+    }
+    else if (isdigit((unsigned char) *field) && (!fraction || decimals)) {
+      value = value * 10 + DIGIT_TO_VAL(*field);
+      if (fraction)
+        decimals--;
+    }
+    else if (!isdigit((unsigned char) *field)) {
+      break;
     }
-    tmp *= 10;
-    if (src[i] >= '0' && src[i] <= '9')
-      tmp += src[i] - '0';
-    if (i >= 15)
-      return 0; // out of bounds
   }
-  return tmp;
+  while (decimals--) {
+    value *= 10;
+  }
+  return value;
+}
+
+static uint8_t hexToVal(char c)
+{
+  if (c >= 'a')
+    return c - 'a' + 10;
+  if (c >= 'A')
+    return c - 'A' + 10;
+  return DIGIT_TO_VAL(c);
+}
+
+#if defined(RTCLOCK)
+static void gpsAdjustRTC(uint16_t year, uint8_t mon, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec)
+{
+  if (g_eeGeneral.adjustRTC) {
+    rtcAdjust(year, mon, day, hour, min, sec);
+  }
+}
+#endif
+
+static void gpsSetPosition(int32_t latitude, int32_t longitude, uint16_t altitude)
+{
+  __disable_irq();    // do the atomic update of lat/lon
+  gpsData.latitude = latitude;
+  gpsData.longitude = longitude;
+  gpsData.altitude = altitude;
+  __enable_irq();
 }
 
-typedef struct gpsDataNmea_s
+#define NMEA_MAX_LENGTH      82   // between '$' and CR LF
+#define NMEA_MAX_FIELDS      20
+
+// NMEA sentence being received, without the leading '$'
+static char nmeaSentence[NMEA_MAX_LENGTH];
+static uint8_t nmeaLength = 0;
+static bool nmeaActive = false;
+
+// Sentences already turned off with $PUBX,40
+#define NMEA_MAX_SILENCED    8
+static char nmeaSilenced[NMEA_MAX_SILENCED][3];
+static uint8_t nmeaSilencedCount = 0;
+
+static void nmeaSilenceSentence(const char * id)
 {
-  uint8_t fix;
-  int32_t latitude;
-  int32_t longitude;
-  uint8_t numSat;
-  uint16_t altitude;
-  uint16_t speed;
-  uint16_t groundCourse;
-  uint16_t hdop;
-  uint32_t date;
-  uint32_t time;
-} gpsDataNmea_t;
-
-bool gpsNewFrameNMEA(char c)
+  for (uint8_t i = 0; i < nmeaSilencedCount; i++) {
+    if (!memcmp(nmeaSilenced[i], id, 3))
+      return;
+  }
+
+  if (nmeaSilencedCount >= NMEA_MAX_SILENCED)
+    return;
+
+  memcpy(nmeaSilenced[nmeaSilencedCount++], id, 3);
+
+  char cmd[] = "$PUBX,40,GSV,0,0,0,0";
+  cmd[9]  = id[0];
+  cmd[10] = id[1];
+  cmd[11] = id[2];
+  gpsSendFrame(cmd);
+}
+
+static bool nmeaProcessGGA(const char * const * fields, uint8_t count)
 {
-  static gpsDataNmea_t gps_Msg;
+  if (count < 10)
+    return false;
+
+  gpsData.fix = fields[6][0] > '0';
+  gpsData.numSat = nmeaParseDecimal(fields[7], 0);
+  gpsData.hdop = nmeaParseDecimal(fields[8], 2);    // hdop * 100
+
+  if (gpsData.fix) {
+    int32_t latitude = GPS_coord_to_degrees(fields[2]);
+    if (fields[3][0] == 'S')
+      latitude = -latitude;
+    int32_t longitude = GPS_coord_to_degrees(fields[4]);
+    if (fields[5][0] == 'W')
+      longitude = -longitude;
+    gpsSetPosition(latitude, longitude, nmeaParseDecimal(fields[9], 0));   // altitude in meters added by Mis
+  }
 
-  uint8_t frameOK = 0;
-  static uint8_t param = 0, offset = 0, parity = 0;
-  static char string[15];
-  static uint8_t checksum_param, gps_frame = NO_FRAME;
+  return true;
+}
 
+static void nmeaProcessRMC(const char * const * fields, uint8_t count)
+{
+  if (count < 10)
+    return;
+
+  gpsData.speed = (nmeaParseDecimal(fields[7], 1) * 5144L) / 1000L;    // speed in cm/s added by Mis
+  gpsData.groundCourse = nmeaParseDecimal(fields[8], 1);               // ground course deg * 10
+
+#if defined(RTCLOCK)
+  // set RTC clock if needed
+  if (fields[2][0] == 'A') {
+    div_t qr = div(nmeaParseDecimal(fields[9], 0), 100);
+    uint8_t year = qr.rem;
+    qr = div(qr.quot, 100);
+    uint8_t mon = qr.rem;
+    uint8_t day = qr.quot;
+    qr = div(nmeaParseDecimal(fields[1], 0), 100);
+    uint8_t sec = qr.rem;
+    qr = div(qr.quot, 100);
+    uint8_t min = qr.rem;
+    uint8_t hour = qr.quot;
+    gpsAdjustRTC(year+2000, mon, day, hour, min, sec);
+  }
+#endif
+}
+
+static bool nmeaProcessSentence(const char * sentence, uint8_t length)
+{
+  const char * end = (const char *)memchr(sentence, '*', length);
+  if (!end || end + 3 > sentence + length) {
+    return false;  // no checksum
+  }
+
+  uint8_t parity = 0;
+  for (const char * c = sentence; c < end; c++) {
+    parity ^= *c;
+  }
+
+  if (parity != (hexToVal(end[1]) << 4 | hexToVal(end[2]))) {
+    gpsData.errorCount++;
+    return false;
+  }
+
+  gpsData.packetCount++;
+
+  // split the fields, each one ends with ',' or '*'
+  const char * fields[NMEA_MAX_FIELDS];
+  uint8_t count = 0;
+  fields[count++] = sentence;
+  for (const char * c = sentence; c < end && count < NMEA_MAX_FIELDS; c++) {
+    if (*c == ',')
+      fields[count++] = c + 1;
+  }
+
+  // Frame identification (accept all GPS talkers (GP: GPS, GL:Glonass, GN:combination, etc...))
+  if (count < 2 || sentence[0] != 'G' || fields[1] - sentence != 6) {
+    return false;
+  }
+
+  const char * id = &sentence[2];
+  if (!memcmp(id, "GGA", 3)) {
+    return nmeaProcessGGA(fields, count);
+  }
+  else if (!memcmp(id, "RMC", 3)) {
+    nmeaProcessRMC(fields, count);
+  }
+  else {
+    // turn off this frame
+    nmeaSilenceSentence(id);
+  }
+
+  return false;
+}
+
+static bool gpsNewFrameNMEA(char c)
+{
   switch (c) {
     case '$':
-      param = 0;
-      offset = 0;
-      parity = 0;
+      nmeaActive = true;
+      nmeaLength = 0;
       break;
-    case ',':
-    case '*':
-      string[offset] = 0;
-      if (param == 0) {
-        // Frame identification (accept all GPS talkers (GP: GPS, GL:Glonass, GN:combination, etc...))
-        gps_frame = NO_FRAME;
-        if (string[0] == 'G' && string[2] == 'G' && string[3] == 'G' && string[4] == 'A') {
-          gps_frame = FRAME_GGA;
-        }
-        else if (string[0] == 'G' && string[2] == 'R' && string[3] == 'M' && string[4] == 'C') {
-          gps_frame = FRAME_RMC;
-        }
-        else {
-          // turn off this frame (do this only once a second)
-          static gtime_t lastGpsCmdSent = 0;
-          if (string[0] == 'G' && g_rtcTime != lastGpsCmdSent) {
-            lastGpsCmdSent = g_rtcTime;
-            char cmd[] = "$PUBX,40,GSV,0,0,0,0";
-            cmd[9]  = string[2];
-            cmd[10] = string[3];
-            cmd[11] = string[4];
-            gpsSendFrame(cmd);
-          }
-        }
-      }
-
-      switch (gps_frame) {
-        case FRAME_GGA:        //************* GPGGA FRAME parsing
-          switch (param) {
-            case 2:
-              gps_Msg.latitude = GPS_coord_to_degrees(string);
-              break;
-            case 3:
-              if (string[0] == 'S')
-                gps_Msg.latitude *= -1;
-              break;
-            case 4:
-              gps_Msg.longitude = GPS_coord_to_degrees(string);
-              break;
-            case 5:
-              if (string[0] == 'W')
-                gps_Msg.longitude *= -1;
-              break;
-            case 6:
-              if (string[0] > '0') {
-                gps_Msg.fix = 1;
-              }
-              else {
-                gps_Msg.fix = 0;
-              }
-              break;
-            case 7:
-              gps_Msg.numSat = grab_fields(string, 0);
-              break;
-            case 8:
-              gps_Msg.hdop = grab_fields(string, 1) * 10;
-              break;
-            case 9:
-              gps_Msg.altitude = grab_fields(string, 0);     // altitude in meters added by Mis
-              break;
-          }
-          break;
-        case FRAME_RMC:        //************* GPRMC FRAME parsing
-          switch (param) {
-            case 1:
-              gps_Msg.time = grab_fields(string, 0);
-              break;
-            case 2:
-              if (string[0] == 'A') {
-                gps_Msg.fix = 1;
-              }
-              else {
-                gps_Msg.fix = 0;
-              }
-              break;
-            case 7:
-              gps_Msg.speed = ((grab_fields(string, 1) * 5144L) / 1000L);    // speed in cm/s added by Mis
-              break;
-            case 8:
-              gps_Msg.groundCourse = (grab_fields(string, 1));      // ground course deg * 10
-              break;
-            case 9:
-              gps_Msg.date = grab_fields(string, 0);
-              break;
-          }
-          break;
 
+    case '\r':
+    case '\n':
+      if (nmeaActive) {
+        nmeaActive = false;
+        return nmeaProcessSentence(nmeaSentence, nmeaLength);
       }
+      break;
 
-      param++;
-      offset = 0;
-      if (c == '*')
-        checksum_param = 1;
-      else
-        parity ^= c;
+    default:
+      if (nmeaActive) {
+        if (nmeaLength < NMEA_MAX_LENGTH)
+          nmeaSentence[nmeaLength++] = c;
+        else
+          nmeaActive = false;  // too long, drop it
+      }
       break;
-    case '\r':
-    case '\n':
-      if (checksum_param) {   //parity checksum
-        uint8_t checksum = 16 * ((string[0] >= 'A') ? string[0] - 'A' + 10 : string[0] - '0') +
-                           ((string[1] >= 'A') ? string[1] - 'A' + 10 : string[1] - '0');
-        if (checksum == parity) {
-          gpsData.packetCount++;
-          switch (gps_frame) {
-            case FRAME_GGA:
-              frameOK = 1;
-              gpsData.fix = gps_Msg.fix;
-              gpsData.numSat = gps_Msg.numSat;
-              gpsData.hdop = gps_Msg.hdop;
-              if (gps_Msg.fix) {
-                __disable_irq();    // do the atomic update of lat/lon
-                gpsData.latitude = gps_Msg.latitude;
-                gpsData.longitude = gps_Msg.longitude;
-                gpsData.altitude = gps_Msg.altitude;
-                __enable_irq();
-              }
-              break;
-            case FRAME_RMC:
-              gpsData.speed = gps_Msg.speed;
-              gpsData.groundCourse = gps_Msg.groundCourse;
+  }
+
+  return false;
+}
+
+#define UBX_SYNC1            0xB5
+#define UBX_SYNC2            0x62
+#define UBX_CLASS_NAV        0x01
+#define UBX_ID_NAV_PVT       0x07
+#define UBX_NAV_PVT_LENGTH   92
+#define UBX_MAX_PAYLOAD      UBX_NAV_PVT_LENGTH
+
+enum UbxState {
+  UBX_IDLE,
+  UBX_SYNC,
+  UBX_CLASS,
+  UBX_ID,
+  UBX_LENGTH_LOW,
+  UBX_LENGTH_HIGH,
+  UBX_PAYLOAD,
+  UBX_CK_A,
+  UBX_CK_B,
+};
+
+static struct {
+  uint8_t state;
+  uint8_t msgClass;
+  uint8_t msgId;
+  uint16_t length;
+  uint16_t index;
+  uint8_t ckA;
+  uint8_t ckB;
+  uint8_t payload[UBX_MAX_PAYLOAD];
+} ubx;
+
+static inline uint16_t ubxGet16(const uint8_t * p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static inline int32_t ubxGet32(const uint8_t * p)
+{
+  return (int32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+static bool ubxProcessNavPvt(const uint8_t * payload)
+{
+  uint8_t fixType = payload[20];
+  gpsData.fix = (payload[21] & 0x01) && fixType >= 2 && fixType <= 4;
+  gpsData.numSat = payload[23];
+  gpsData.hdop = ubxGet16(&payload[76]);                    // pDOP * 100
+  gpsData.speed = ubxGet32(&payload[60]) / 10;              // mm/s to cm/s
+  gpsData.groundCourse = ubxGet32(&payload[64]) / 10000;    // 1e-5 deg to 0.1 deg
+
+  if (gpsData.fix) {
+    gpsSetPosition(ubxGet32(&payload[28]) / 10,   // 1e-7 deg to 1e-6 deg
+                   ubxGet32(&payload[24]) / 10,
+                   ubxGet32(&payload[36]) / 1000); // mm to m
+  }
+
 #if defined(RTCLOCK)
-              // set RTC clock if needed
-              if (g_eeGeneral.adjustRTC && gps_Msg.fix) {
-                div_t qr = div(gps_Msg.date, 100);
-                uint8_t year = qr.rem;
-                qr = div(qr.quot, 100);
-                uint8_t mon = qr.rem;
-                uint8_t day = qr.quot;
-                qr = div(gps_Msg.time, 100);
-                uint8_t sec = qr.rem;
-                qr = div(qr.quot, 100);
-                uint8_t min = qr.rem;
-                uint8_t hour = qr.quot;
-                rtcAdjust(year+2000, mon, day, hour, min, sec);
-              }
+  // set RTC clock if needed, with valid date and time
+  if (gpsData.fix && (payload[11] & 0x03) == 0x03) {
+    gpsAdjustRTC(ubxGet16(&payload[4]), payload[6], payload[7], payload[8], payload[9], payload[10]);
+  }
 #endif
-          } // end switch
-        }
-        else {
-          gpsData.errorCount++;
-        }
+
+  return true;
+}
+
+static bool gpsNewFrameUBX(uint8_t c)
+{
+  if (ubx.state >= UBX_CLASS && ubx.state <= UBX_PAYLOAD) {
+    ubx.ckA += c;
+    ubx.ckB += ubx.ckA;
+  }
+
+  switch (ubx.state) {
+    case UBX_IDLE:
+      ubx.state = UBX_SYNC;
+      break;
+
+    case UBX_SYNC:
+      if (c == UBX_SYNC2) {
+        ubx.state = UBX_CLASS;
+        ubx.ckA = ubx.ckB = 0;
+      }
+      else if (c != UBX_SYNC1) {
+        // not a UBX frame, the byte belongs to the NMEA stream
+        ubx.state = UBX_IDLE;
+        return gpsNewFrameNMEA(c);
+      }
+      break;
+
+    case UBX_CLASS:
+      ubx.msgClass = c;
+      ubx.state = UBX_ID;
+      break;
+
+    case UBX_ID:
+      ubx.msgId = c;
+      ubx.state = UBX_LENGTH_LOW;
+      break;
+
+    case UBX_LENGTH_LOW:
+      ubx.length = c;
+      ubx.state = UBX_LENGTH_HIGH;
+      break;
+
+    case UBX_LENGTH_HIGH:
+      ubx.length |= c << 8;
+      ubx.index = 0;
+      if (ubx.length > UBX_MAX_PAYLOAD) {
+        // not a message we decode, or a corrupted length: waiting for
+        // its end could swallow up to 64KB of the stream
+        ubx.state = UBX_IDLE;
+        break;
+      }
+      ubx.state = ubx.length ? UBX_PAYLOAD : UBX_CK_A;
+      break;
+
+    case UBX_PAYLOAD:
+      ubx.payload[ubx.index] = c;
+      if (++ubx.index >= ubx.length)
+        ubx.state = UBX_CK_A;
+      break;
+
+    case UBX_CK_A:
+      ubx.state = (c == ubx.ckA) ? UBX_CK_B : UBX_IDLE;
+      if (c != ubx.ckA)
+        gpsData.errorCount++;
+      break;
+
+    case UBX_CK_B:
+      ubx.state = UBX_IDLE;
+      if (c != ubx.ckB) {
+        gpsData.errorCount++;
+        break;
+      }
+      gpsData.packetCount++;
+      if (ubx.msgClass == UBX_CLASS_NAV && ubx.msgId == UBX_ID_NAV_PVT &&
+          ubx.length == UBX_NAV_PVT_LENGTH) {
+        return ubxProcessNavPvt(ubx.payload);
       }
-      checksum_param = 0;
       break;
-    default:
-      if (offset < 15)
-        string[offset++] = c;
-      if (!checksum_param)
-        parity ^= c;
   }
-  return frameOK;
+
+  return false;
 }
 
 bool gpsNewFrame(uint8_t c)
 {
+  // UBX sync byte is never part of an NMEA sentence
+  if (ubx.state != UBX_IDLE || c == UBX_SYNC1) {
+    return gpsNewFrameUBX(c);
+  }
   return gpsNewFrameNMEA(c);
 }
 
@@ -331,12 +484,30 @@ void gpsSetSerialDriver(void* ctx, const etx_serial_driver_t* drv)
 {
   gpsSerialCtx = ctx;
   gpsSerialDrv = drv;
+  nmeaSilencedCount = 0;
 }
 
 void gpsWakeup()
 {
   if (!gpsSerialDrv) return;
-  
+
+  auto _getBuffer = gpsSerialDrv->getBuffer;
+  if (_getBuffer) {
+    uint8_t buffer[32];
+    int count;
+    while ((count = _getBuffer(gpsSerialCtx, buffer, sizeof(buffer))) > 0) {
+      for (int i = 0; i < count; i++) {
+#if defined(DEBUG)
+        if (gpsTraceEnabled) {
+          dbgSerialPutc(buffer[i]);
+        }
+#endif
+        gpsNewData(buffer[i]);
+      }
+    }
+    return;
+  }
+
   auto _getByte = gpsSerialDrv->getByte;
   if (!_getByte) return;
 
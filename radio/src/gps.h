@@ -50,6 +50,9 @@ void gpsSetSerialDriver(void* ctx, const etx_serial_driver_t* drv);
 // Periodic processing
 void gpsWakeup();
 
+// Decode one byte received from the GPS (NMEA or UBX)
+void gpsNewData(uint8_t c);
+
 // Send a 0-terminated frame
 void gpsSendFrame(const char * frame);
 
@@ -131,7 +131,8 @@ const unsigned char font_xxl[] = {
 // -2 for: overall length and last boundary
 const uint16_t fontCharactersTable[FONTS_COUNT] = { sizeof(font_std_en_specs)/2-2 };
 const uint16_t * const fontspecsTable[FONTS_COUNT] = { font_std_en_specs };
-const uint8_t * fontsTable[FONTS_COUNT] = { font_std_en };
+const uint8_t * fontsTable[FONTS_COUNT] = { nullptr };
+const uint8_t * const fontsCompressedTable[FONTS_COUNT] = { font_std_en };
 const int fontsSizeTable[FONTS_COUNT] = { sizeof(font_std_en) };
 #else
 // -2 for: overall length and last boundary
@@ -144,7 +145,10 @@ const uint16_t *const fontspecsTable[FONTS_COUNT] = {
     font_std_specs, font_bold_specs, font_xxs_specs, font_xs_specs,
     font_l_specs,   font_xl_specs,   font_xxl_specs
 };
-const uint8_t *fontsTable[FONTS_COUNT] = {
+// Decompressed fonts only: the fonts not decompressed yet point to the STD
+// font, which stays loaded, so that fontsTable[] never holds compressed data
+const uint8_t *fontsTable[FONTS_COUNT] = { nullptr };
+const uint8_t * const fontsCompressedTable[FONTS_COUNT] = {
     font_std, font_bold, font_xxs, font_xs, font_l, font_xl, font_xxl
 };
 const int fontsSizeTable[FONTS_COUNT] = {
@@ -166,6 +170,9 @@ uint8_t * decompressFont(const uint8_t * font, unsigned len)
 
   size_t font_size = width * height;
   uint8_t * buf = (uint8_t *)malloc(font_size + 4);
+  if (!buf) {
+    return nullptr;
+  }
 
   ((uint16_t*)buf)[0] = (uint16_t)width;
   ((uint16_t*)buf)[1] = (uint16_t)height;
@@ -185,19 +192,68 @@ uint8_t * decompressFont(const uint8_t * font, unsigned len)
   return buf;
 }
 
-void loadFonts()
+static uint32_t fontsLoadedMask = 0;
+#if !defined(BOOT)
+static tmr10ms_t fontsLastUse[FONTS_COUNT];
+#endif
+
+const uint8_t * getFontBitmap(unsigned fontindex)
 {
-  static bool fontsLoaded = false;
-  if (fontsLoaded)
-    return;
+  if (!(fontsLoadedMask & (1 << fontindex))) {
+#if defined(DEBUG) && !defined(BOOT)
+    uint32_t start = RTOS_GET_MS();
+#endif
+    uint8_t * font = decompressFont(fontsCompressedTable[fontindex], fontsSizeTable[fontindex]);
+    if (!font) {
+      // fontsTable[] still points to the STD font
+      TRACE("getFontBitmap(%d): out of memory", fontindex);
+      return nullptr;
+    }
+    fontsTable[fontindex] = font;
+    fontsLoadedMask |= 1 << fontindex;
+#if defined(DEBUG) && !defined(BOOT)
+    TRACE("getFontBitmap(%d): decompressed in %d ms", fontindex, RTOS_GET_MS() - start);
+#endif
+  }
+#if !defined(BOOT)
+  fontsLastUse[fontindex] = get_tmr10ms();
+#endif
+  return fontsTable[fontindex];
+}
 
-#if defined(BOOT)
-  fontsTable[0] = decompressFont(fontsTable[0], fontsSizeTable[0]);
-#else
-  for (int i = 0; i < FONTS_COUNT; i++) {
-    fontsTable[i] = decompressFont(fontsTable[i], fontsSizeTable[i]);
+bool isFontLoaded(unsigned fontindex)
+{
+  return fontsLoadedMask & (1 << fontindex);
+}
+
+#if !defined(BOOT)
+unsigned unloadUnusedFonts(tmr10ms_t maxAge)
+{
+  unsigned count = 0;
+  tmr10ms_t now = get_tmr10ms();
+  // the STD font is never freed
+  for (unsigned i = 1; i < FONTS_COUNT; i++) {
+    if ((fontsLoadedMask & (1 << i)) && tmr10ms_t(now - fontsLastUse[i]) >= maxAge) {
+      free((void *)fontsTable[i]);
+      fontsTable[i] = fontsTable[0];
+      fontsLoadedMask &= ~(1 << i);
+      count++;
+    }
   }
+  return count;
+}
 #endif
 
-  fontsLoaded = true;
+void loadFonts()
+{
+  // The other fonts are decompressed the first time text is drawn with
+  // them (see getFontHeight()), they point to the STD font until then
+  if (!getFontBitmap(0))
+    return;
+
+  for (unsigned i = 1; i < FONTS_COUNT; i++) {
+    if (!isFontLoaded(i)) {
+      fontsTable[i] = fontsTable[0];
+    }
+  }
 }
@@ -21,4 +21,17 @@
 
 #pragma once
 
+#include "opentx_types.h"
+
 void loadFonts();
+
+// Returns the decompressed bitmap of a font, decompressing it on first use
+const uint8_t * getFontBitmap(unsigned fontindex);
+
+bool isFontLoaded(unsigned fontindex);
+
+#define FONT_UNLOAD_DELAY  100 // 1s
+
+// Frees the fonts not used for maxAge (10ms units), returns how many were
+// freed. Must be called from the UI task, outside of any text drawing
+unsigned unloadUnusedFonts(tmr10ms_t maxAge);
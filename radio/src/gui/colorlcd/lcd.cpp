@@ -21,6 +21,7 @@
 
 #include "lcd.h"
 #include "opentx.h"
+#include "fonts.h"
 
 uint8_t getMappedChar(uint8_t c)
 {
@@ -46,6 +47,9 @@ int getCharWidth(uint8_t c, const uint16_t * spec)
 uint8_t getFontHeight(LcdFlags flags)
 {
   uint32_t fontindex = FONT_INDEX(flags);
+  // BitmapBuffer::drawSizedText() asks for the height before it reads
+  // fontsTable[], this is where fonts get decompressed on first use
+  getFontBitmap(fontindex);
   return fontspecsTable[fontindex][0];
 }
 
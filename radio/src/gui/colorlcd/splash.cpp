@@ -63,6 +63,7 @@ void drawSplash()
 	}
   }
 
+  DMABatchBegin();
   lcd->clear(splash_background_color);
 
   if (splashImg) {
@@ -70,6 +71,7 @@ void drawSplash()
                     (LCD_H - splashImg->height())/2,
                     splashImg);
   }
+  DMABatchEnd();
 
   lcdRefresh();
 }
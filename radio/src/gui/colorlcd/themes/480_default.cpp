@@ -310,8 +310,10 @@ class Theme480: public OpenTxTheme
     void drawBackground(BitmapBuffer * dc) const override
     {
       if (backgroundBitmap) {
+        DMABatchBegin();
         dc->clear(COLOR_THEME_SECONDARY3);
         dc->drawBitmap(0 - dc->getOffsetX(), 0 - dc->getOffsetY(), backgroundBitmap);
+        DMABatchEnd();
       }
       else {
         dc->drawSolidFilledRect(0 - dc->getOffsetX(), 0 - dc->getOffsetY(),
@@ -322,14 +324,18 @@ class Theme480: public OpenTxTheme
     void drawTopLeftBitmap(BitmapBuffer * dc) const override
     {
       if (topleftBitmap) {
+        DMABatchBegin();
         dc->drawBitmap(0, 0, topleftBitmap);
         dc->drawBitmap(4, 10, menuIconSelected[ICON_OPENTX]);
+        DMABatchEnd();
       }
     }
 
     void drawPageHeaderBackground(BitmapBuffer *dc, uint8_t icon,
                                   const char *title) const override
     {
+      // bitmaps and fills only: run them back to back on the DMA2D
+      DMABatchBegin();
       if (topleftBitmap) {
         dc->drawBitmap(0, 0, topleftBitmap);
         uint16_t width = topleftBitmap->width();
@@ -350,6 +356,8 @@ class Theme480: public OpenTxTheme
 
       dc->drawSolidFilledRect(0, MENU_TITLE_TOP, LCD_W, MENU_TITLE_HEIGHT,
                               COLOR_THEME_SECONDARY1);  // the title line background
+      DMABatchEnd();
+
       if (title) {
         dc->drawText(MENUS_MARGIN_LEFT, MENU_TITLE_TOP + 3, title, COLOR_THEME_PRIMARY2);
       }
@@ -370,6 +378,7 @@ class Theme480: public OpenTxTheme
     void drawPageHeader(BitmapBuffer *dc, std::vector<PageTab *> &tabs,
                         uint8_t currentIndex) const override
     {
+      DMABatchBegin();
       for (unsigned index = 0; index < tabs.size(); index++) {
         if (index != currentIndex) {
           dc->drawBitmap(index * MENU_HEADER_BUTTON_WIDTH + 2, 7,
@@ -380,6 +389,7 @@ class Theme480: public OpenTxTheme
                      currentMenuBackground);
       dc->drawBitmap(currentIndex * MENU_HEADER_BUTTON_WIDTH + 2, 7,
                      menuIconSelected[tabs[currentIndex]->getIcon()]);
+      DMABatchEnd();
     }
 
     void drawMenuDatetime(BitmapBuffer * dc) const
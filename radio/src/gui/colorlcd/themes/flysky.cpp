@@ -321,9 +321,11 @@ class FlyskyTheme: public OpenTxTheme
     void drawTopLeftBitmap(BitmapBuffer * dc) const override
     {
       if (topleftBitmap) {
+        DMABatchBegin();
         dc->drawBitmap(0, 0, topleftBitmap);
         uint16_t width = topleftBitmap->width();
         dc->drawSolidFilledRect(width, 0, LCD_W - width, MENU_HEADER_HEIGHT, COLOR_THEME_PRIMARY2);
+        DMABatchEnd();
       }
     }
 
@@ -337,6 +339,7 @@ class FlyskyTheme: public OpenTxTheme
       //        MENU_HEADER_HEIGHT, COLOR_THEME_FOCUS);
       //      }
       //      else {
+      DMABatchBegin();
       dc->drawSolidFilledRect(0, 0, LCD_W, MENU_HEADER_HEIGHT, COLOR_THEME_FOCUS);
       //      }
       //
@@ -350,7 +353,8 @@ class FlyskyTheme: public OpenTxTheme
                               COLOR_THEME_SECONDARY3);  // the white separation line
       dc->drawSolidFilledRect(0, MENU_TITLE_TOP, LCD_W, MENU_TITLE_HEIGHT,
                               COLOR_THEME_SECONDARY1);  // the title line background
-                                               //
+      DMABatchEnd();
+
       if (title) {
         dc->drawText(MENUS_MARGIN_LEFT, MENU_TITLE_TOP + 2, title, COLOR_THEME_SECONDARY1);
       }
@@ -371,6 +375,7 @@ class FlyskyTheme: public OpenTxTheme
     {
       uint8_t padding_left = 4;
 
+      DMABatchBegin();
       dc->drawSolidFilledRect(0, 0, 4, MENU_HEADER_BUTTON_WIDTH,
                               COLOR_THEME_FOCUS);
       for (unsigned i = 0; i < tabs.size(); i++) {
@@ -379,6 +384,7 @@ class FlyskyTheme: public OpenTxTheme
             theme->getIcon(tabs[i]->getIcon(),
                            currentIndex == i ? STATE_PRESSED : STATE_DEFAULT));
       }
+      DMABatchEnd();
       //      coord_t x = padding_left + MENU_HEADER_BUTTON_WIDTH * tabs.size();
       //      coord_t w = width() - x;
       //      if (w > 0) {
@@ -75,6 +75,10 @@ typedef struct {
   // Fetch byte from internal buffer
   int (*getByte)(void* ctx, uint8_t* data);
 
+  // Fetch up to 'len' bytes from internal buffer,
+  // returns the number of bytes copied
+  int (*getBuffer)(void* ctx, uint8_t* data, uint32_t len);
+
   // Get current baudrate
   uint32_t (*getBaudrate)(void*);
   
@@ -21,10 +21,13 @@
 
 #include <cctype>
 #include <cstdio>
+#include <list>
+#include <string>
 #include "opentx.h"
 #include "libopenui.h"
 #include "widget.h"
 #include "api_colorlcd.h"
+#include "fonts.h"
 
 BitmapBuffer* luaLcdBuffer  = nullptr;
 Widget* runningFS = nullptr;
@@ -82,6 +85,27 @@ static int luaLcdRefresh(lua_State *L)
   return 0;
 }
 
+/*luadoc
+@function lcd.invalidate()
+
+Request a redraw of the widget currently running.
+
+Only useful for widgets declaring a `watch` list of sources: these are
+redrawn only when one of the watched sources changes or when
+lcd.invalidate() is called (i.e. from the widget background() function).
+
+@notice Only available on radios with color display
+
+@status current Introduced in 2.8.0
+*/
+static int luaLcdInvalidate(lua_State *L)
+{
+  if (runningFS) {
+    runningFS->invalidate();
+  }
+  return 0;
+}
+
 /*luadoc
 @function lcd.clear([color])
 
@@ -507,6 +531,8 @@ static int luaLcdDrawSource(lua_State *L)
 Loads a bitmap in memory, for later use with lcd.drawBitmap(). Bitmaps should be loaded only
 once, returned object should be stored and used for drawing. If loading fails for whatever
 reason the resulting bitmap object will have width and height set to zero.
+Opening the same file several times (even from different scripts) shares
+the same bitmap data in memory.
 
 Bitmap loading can fail if:
  * File is not found or contains invalid image
@@ -521,30 +547,128 @@ Bitmap loading can fail if:
 
 @status current Introduced in 2.2.0
 */
-static int luaOpenBitmap(lua_State *L)
+// Decoded bitmaps are shared between all Lua states: opening the same
+// file several times (i.e. several instances of the same widget) only
+// decodes and stores it once. Bitmaps no longer referenced are kept
+// around (most recently used first) up to LUA_BITMAP_CACHE_IDLE_MAX bytes.
+#if !defined(LUA_BITMAP_CACHE_IDLE_MAX)
+  #define LUA_BITMAP_CACHE_IDLE_MAX (LUA_MEM_EXTRA_MAX / 8)
+#endif
+
+struct LuaBitmapCacheEntry {
+  std::string path;
+  BitmapBuffer * bitmap;
+  uint32_t refs;
+};
+
+static std::list<LuaBitmapCacheEntry> luaBitmapCache;
+
+static void luaBitmapCacheFree(std::list<LuaBitmapCacheEntry>::iterator it)
 {
-  const char *filename = luaL_checkstring(L, 1);
+  uint32_t size = it->bitmap->getDataSize();
+  TRACE("luaBitmapCacheFree: %p (%u)", it->bitmap, size);
+  if (luaExtraMemoryUsage >= size) {
+    luaExtraMemoryUsage -= size;
+  }
+  else {
+    luaExtraMemoryUsage = 0;
+  }
+  delete it->bitmap;
+  luaBitmapCache.erase(it);
+}
 
-  BitmapBuffer **b =
-      (BitmapBuffer **)lua_newuserdata(L, sizeof(BitmapBuffer *));
+// Drop unreferenced bitmaps, least recently used first,
+// until they use no more than maxIdle bytes
+static void luaBitmapCacheTrim(uint32_t maxIdle)
+{
+  uint32_t idle = 0;
+  for (auto & entry: luaBitmapCache) {
+    if (entry.refs == 0)
+      idle += entry.bitmap->getDataSize();
+  }
+
+  auto it = luaBitmapCache.end();
+  while (idle > maxIdle && it != luaBitmapCache.begin()) {
+    --it;
+    if (it->refs == 0) {
+      idle -= it->bitmap->getDataSize();
+      luaBitmapCacheFree(it++);
+    }
+  }
+}
+
+static BitmapBuffer * luaBitmapCacheFind(const char * filename)
+{
+  for (auto it = luaBitmapCache.begin(); it != luaBitmapCache.end(); ++it) {
+    if (it->path == filename) {
+      it->refs++;
+      luaBitmapCache.splice(luaBitmapCache.begin(), luaBitmapCache, it);
+      return it->bitmap;
+    }
+  }
+  return nullptr;
+}
+
+static BitmapBuffer * luaBitmapCacheLoad(lua_State * L, const char * filename)
+{
+  if (luaExtraMemoryUsage > LUA_MEM_EXTRA_MAX) {
+    // first try to make some room by dropping unused bitmaps
+    luaBitmapCacheTrim(0);
+  }
 
   if (luaExtraMemoryUsage > LUA_MEM_EXTRA_MAX) {
     // already allocated more than max allowed, fail
     TRACE("luaOpenBitmap: Error, using too much memory %u/%u",
           luaExtraMemoryUsage, LUA_MEM_EXTRA_MAX);
-    *b = 0;
-  } else {
-    *b = BitmapBuffer::loadBitmap(filename);
-    if (*b == NULL && G(L)->gcrunning) {
-      luaC_fullgc(L, 1);                       /* try to free some memory... */
-      *b = BitmapBuffer::loadBitmap(filename); /* try again */
+    return nullptr;
+  }
+
+  BitmapBuffer * bitmap = BitmapBuffer::loadBitmap(filename);
+  if (bitmap == nullptr) {
+    luaBitmapCacheTrim(0);
+    bitmap = BitmapBuffer::loadBitmap(filename);
+  }
+  if (bitmap == nullptr && unloadUnusedFonts(FONT_UNLOAD_DELAY) > 0) {
+    bitmap = BitmapBuffer::loadBitmap(filename);
+  }
+  if (bitmap == nullptr && G(L)->gcrunning) {
+    luaC_fullgc(L, 1);                          /* try to free some memory... */
+    bitmap = BitmapBuffer::loadBitmap(filename); /* try again */
+  }
+  if (bitmap == nullptr) {
+    return nullptr;
+  }
+
+  uint32_t size = bitmap->getDataSize();
+  luaExtraMemoryUsage += size;
+  TRACE("luaOpenBitmap: %p (%u)", bitmap, size);
+
+  luaBitmapCache.push_front({filename, bitmap, 1});
+  return bitmap;
+}
+
+static void luaBitmapCacheRelease(BitmapBuffer * bitmap)
+{
+  for (auto & entry: luaBitmapCache) {
+    if (entry.bitmap == bitmap) {
+      if (entry.refs > 0 && --entry.refs == 0) {
+        luaBitmapCacheTrim(LUA_BITMAP_CACHE_IDLE_MAX);
+      }
+      return;
     }
   }
+}
+
+static int luaOpenBitmap(lua_State *L)
+{
+  const char *filename = luaL_checkstring(L, 1);
+
+  BitmapBuffer **b =
+      (BitmapBuffer **)lua_newuserdata(L, sizeof(BitmapBuffer *));
 
-  if (*b) {
-    uint32_t size = (*b)->getDataSize();
-    luaExtraMemoryUsage += size;
-    TRACE("luaOpenBitmap: %p (%u)", *b, size);
+  *b = luaBitmapCacheFind(filename);
+  if (*b == nullptr) {
+    *b = luaBitmapCacheLoad(L, filename);
   }
 
   luaL_getmetatable(L, LUA_BITMAPHANDLE);
@@ -592,15 +716,8 @@ static int luaDestroyBitmap(lua_State * L)
 {
   BitmapBuffer * b = checkBitmap(L, 1);
   if (b) {
-    uint32_t size = b->getDataSize();
-    TRACE("luaDestroyBitmap: %p (%u)", b, size);
-    if (luaExtraMemoryUsage >= size) {
-      luaExtraMemoryUsage -= size;
-    }
-    else {
-      luaExtraMemoryUsage = 0;
-    }
-    delete b;
+    TRACE("luaDestroyBitmap: %p", b);
+    luaBitmapCacheRelease(b);
   }
   return 0;
 }
@@ -1243,6 +1360,7 @@ static int luaLcdExitFullScreen(lua_State *L)
 
 const luaL_Reg lcdLib[] = {
   { "refresh", luaLcdRefresh },
+  { "invalidate", luaLcdInvalidate },
   { "clear", luaLcdClear },
   { "resetBacklightTimeout", luaLcdResetBacklightTimeout },
   { "drawPoint", luaLcdDrawPoint },
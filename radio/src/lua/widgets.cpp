@@ -31,6 +31,7 @@
 
 #define MAX_INSTRUCTIONS       (20000/100)
 #define LUA_WARNING_INFO_LEN    64
+#define LUA_WIDGET_MAX_WATCH    8
 
 #if defined(HARDWARE_TOUCH)
 #include "touch.h"
@@ -277,8 +278,12 @@ class LuaWidget: public Widget
     static tmr10ms_t swipeTimeOut;
 #endif  
 
+    // last values of the sources watched by the widget
+    getvalue_t watchedValues[LUA_WIDGET_MAX_WATCH] = { 0 };
+
     void checkEvents() override;
     void setErrorMessage(const char * funcName);
+    bool checkWatchedSources();
   
   private:
     eventData* findOpenEventSlot(event_t event = 0);
@@ -316,7 +321,9 @@ class LuaWidgetFactory: public WidgetFactory
       createFunction(createFunction),
       updateFunction(0),
       refreshFunction(0),
-      backgroundFunction(0)
+      backgroundFunction(0),
+      lazyRefresh(false),
+      watchCount(0)
     {
     }
 
@@ -372,6 +379,12 @@ class LuaWidgetFactory: public WidgetFactory
     int updateFunction;
     int refreshFunction;
     int backgroundFunction;
+
+    // Widgets declaring a 'watch' list are only redrawn when one of
+    // these sources changes, or when they call lcd.invalidate()
+    bool lazyRefresh;
+    uint8_t watchCount;
+    mixsrc_t watch[LUA_WIDGET_MAX_WATCH];
 };
 
 // Look for a slot in the event buffer that is either unused (zero) or matches event
@@ -396,6 +409,14 @@ void LuaWidget::checkEvents()
   }
   
   refreshed = false;
+
+  LuaWidgetFactory * factory = (LuaWidgetFactory *)this->factory;
+  if (factory->lazyRefresh && !fullscreen && !errorMessage) {
+    // leave the zone untouched until something it displays has changed
+    if (!checkWatchedSources())
+      return;
+  }
+
   invalidate();
 
 #if defined(DEBUG_WINDOWS)
@@ -403,9 +424,24 @@ void LuaWidget::checkEvents()
 #endif
 }
 
+bool LuaWidget::checkWatchedSources()
+{
+  LuaWidgetFactory * factory = (LuaWidgetFactory *)this->factory;
+  bool changed = false;
+  for (uint8_t i = 0; i < factory->watchCount; i++) {
+    getvalue_t value = getValue(factory->watch[i]);
+    if (value != watchedValues[i]) {
+      watchedValues[i] = value;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
 void LuaWidget::update()
 {
   Widget::update();
+  invalidate();
   
   if (lsWidgets == 0 || errorMessage) return;
 
@@ -656,6 +692,9 @@ void luaLoadWidgetCallback()
   TRACE("luaLoadWidgetCallback()");
   const char * name=NULL;
   int widgetOptions=0, createFunction=0, updateFunction=0, refreshFunction=0, backgroundFunction=0;
+  bool lazyRefresh = false;
+  uint8_t watchCount = 0;
+  mixsrc_t watch[LUA_WIDGET_MAX_WATCH];
 
   luaL_checktype(lsWidgets, -1, LUA_TTABLE);
 
@@ -684,6 +723,25 @@ void luaLoadWidgetCallback()
       backgroundFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
       lua_pushnil(lsWidgets);
     }
+    else if (!strcmp(key, "watch")) {
+      luaL_checktype(lsWidgets, -1, LUA_TTABLE);
+      lazyRefresh = true;
+      for (lua_pushnil(lsWidgets); lua_next(lsWidgets, -2); lua_pop(lsWidgets, 1)) {
+        if (watchCount >= LUA_WIDGET_MAX_WATCH) {
+          TRACE("Lua widget %s: too many watched sources", name ? name : "");
+          continue;
+        }
+        if (lua_isnumber(lsWidgets, -1)) {
+          watch[watchCount++] = lua_tointeger(lsWidgets, -1);
+        }
+        else {
+          LuaField field;
+          if (luaFindFieldByName(luaL_checkstring(lsWidgets, -1), field)) {
+            watch[watchCount++] = field.id;
+          }
+        }
+      }
+    }
   }
 
   if (name && createFunction) {
@@ -693,6 +751,9 @@ void luaLoadWidgetCallback()
       factory->updateFunction = updateFunction;
       factory->refreshFunction = refreshFunction;
       factory->backgroundFunction = backgroundFunction;   // NOSONAR
+      factory->lazyRefresh = lazyRefresh;
+      factory->watchCount = watchCount;
+      memcpy(factory->watch, watch, watchCount * sizeof(mixsrc_t));
       TRACE("Loaded Lua widget %s", name);
     }
   }
@@ -287,6 +287,9 @@ void checkEeprom()
   if (TIME_TO_WRITE()) {
     storageCheck(false);
   }
+#if defined(STORAGE_TASK)
+  storageCheckWritten();
+#endif
 }
 #endif
 
@@ -962,19 +962,37 @@ constexpr uint8_t SD_SCREEN_FILE_LENGTH = 64;
 
 constexpr uint8_t TEXT_FILENAME_MAXLEN = 40;
 
+#if defined(SDCARD) && !defined(COLORLCD)
+struct ModelSelectionBuffers
+{
+#if defined(EEPROM_RLC) && LCD_W < 212
+  uint16_t eepromfree;
+#endif
+  char menu_bss[POPUP_MENU_MAX_LINES][MENU_LINE_LENGTH];
+  char mainname[45]; // because reused for SD backup / restore, max backup filename 44 chars: "/MODELS/MODEL0134353-2014-06-19-04-51-27.bin"
+};
+
+// Room left for the directory snapshot of sdListFiles(), so that the
+// model selection buffers do not grow beyond the USB mass storage one
+constexpr uint16_t SD_LIST_CACHE_SIZE = MSC_MEDIA_PACKET - sizeof(ModelSelectionBuffers);
+#endif
+
 union ReusableBuffer
 {
+#if defined(SDCARD) && !defined(COLORLCD)
+  struct : ModelSelectionBuffers {
+    char listCache[SD_LIST_CACHE_SIZE];
+  } modelsel;
+#else
   struct {
 #if defined(EEPROM_RLC) && LCD_W < 212
     uint16_t eepromfree;
 #endif
-#if defined(SDCARD) && !defined(COLORLCD)
-    char menu_bss[POPUP_MENU_MAX_LINES][MENU_LINE_LENGTH];
-    char mainname[45]; // because reused for SD backup / restore, max backup filename 44 chars: "/MODELS/MODEL0134353-2014-06-19-04-51-27.bin"
-#elif !defined(COLORLCD)
+#if !defined(COLORLCD)
     char mainname[LEN_MODEL_NAME];
 #endif
   } modelsel;
+#endif
 
   struct {
     char msg[64];
@@ -1102,6 +1120,11 @@ union ReusableBuffer
   uint8_t MSC_BOT_Data[MSC_MEDIA_PACKET];
 };
 
+#if defined(SDCARD) && !defined(COLORLCD)
+static_assert(sizeof(ReusableBuffer::modelsel) <= MSC_MEDIA_PACKET,
+              "Model selection buffers larger than the USB mass storage one");
+#endif
+
 extern ReusableBuffer reusableBuffer;
 
 uint8_t zlen(const char *str, uint8_t size);
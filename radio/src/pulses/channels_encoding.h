@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include "opentx.h"
+
+// Offset of the PPM center of a channel from the default center,
+// in channelOutputs[] units
+inline int getChannelCenterOffset(uint8_t channel)
+{
+  return 2 * PPM_CH_CENTER(channel) - 2 * PPM_CENTER;
+}
+
+// Channel output with its PPM center applied
+// Range is [-1024:+1024] for [-100%;100%]
+inline int getChannelOutput(uint8_t channel)
+{
+  return channelOutputs[channel] + getChannelCenterOffset(channel);
+}
+
+// Packs 11 bit channel values, LSB first, as sent by SBUS, CRSF and
+// Multi frames. Each group of 8 channels fills exactly 11 bytes, so
+// 'count' must be a multiple of 8. Returns the end of the packed data.
+inline uint8_t * packChannels11Bits(uint8_t * buf, const uint16_t * values, uint8_t count)
+{
+  for (; count >= 8; count -= 8, values += 8, buf += 11) {
+    buf[0] = values[0];
+    buf[1] = (values[0] >> 8) | (values[1] << 3);
+    buf[2] = (values[1] >> 5) | (values[2] << 6);
+    buf[3] = values[2] >> 2;
+    buf[4] = (values[2] >> 10) | (values[3] << 1);
+    buf[5] = (values[3] >> 7) | (values[4] << 4);
+    buf[6] = (values[4] >> 4) | (values[5] << 7);
+    buf[7] = values[5] >> 1;
+    buf[8] = (values[5] >> 9) | (values[6] << 2);
+    buf[9] = (values[6] >> 6) | (values[7] << 5);
+    buf[10] = values[7] >> 3;
+  }
+  return buf;
+}
+
+// Unpacks 11 bit channel values packed by packChannels11Bits().
+// Returns the end of the packed data.
+inline const uint8_t * unpackChannels11Bits(const uint8_t * buf, uint16_t * values, uint8_t count)
+{
+  for (; count >= 8; count -= 8, values += 8, buf += 11) {
+    values[0] = (buf[0] | buf[1] << 8) & 0x7FF;
+    values[1] = (buf[1] >> 3 | buf[2] << 5) & 0x7FF;
+    values[2] = (buf[2] >> 6 | buf[3] << 2 | buf[4] << 10) & 0x7FF;
+    values[3] = (buf[4] >> 1 | buf[5] << 7) & 0x7FF;
+    values[4] = (buf[5] >> 4 | buf[6] << 4) & 0x7FF;
+    values[5] = (buf[6] >> 7 | buf[7] << 1 | buf[8] << 9) & 0x7FF;
+    values[6] = (buf[8] >> 2 | buf[9] << 6) & 0x7FF;
+    values[7] = (buf[9] >> 5 | buf[10] << 3) & 0x7FF;
+  }
+  return buf;
+}
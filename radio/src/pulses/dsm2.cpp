@@ -20,6 +20,9 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
+#include "channels_encoding.h"
+#include "extmodule_driver.h"
 
 #define DSM2_SEND_BIND                     (1 << 7)
 #define DSM2_SEND_RANGECHECK               (1 << 5)
@@ -33,35 +36,10 @@
 
 #define BITLEN_DSM2          (8*2) //125000 Baud => 8uS per bit
 
-static void reset_dsm2_buffer()
+// 8N1: start bit, 8 data bits (lsb first), 1 stop bit
+static void _sendByte(uint8_t b, uint8_t bit_len)
 {
-  extmodulePulsesData.dsm2.index = 0;
-  extmodulePulsesData.dsm2.ptr = extmodulePulsesData.dsm2.pulses;
-}
-
-static void _send_1(uint8_t v)
-{
-  *extmodulePulsesData.dsm2.ptr++ = v - 1;
-  extmodulePulsesData.dsm2.index += 1;
-}
-
-static void _sendByte(uint8_t b, uint8_t bit_len) // max 10 changes 0 10 10 10 10 1
-{
-  bool    lev = 0;
-  uint8_t len = bit_len; // max val: 9*16 < 256
-  for (uint8_t i=0; i<=8; i++) { // 8Bits + Stop=1
-    bool nlev = b & 1; // lsb first
-    if (lev == nlev) {
-      len += bit_len;
-    }
-    else {
-      _send_1(len);
-      len  = bit_len;
-      lev  = nlev;
-    }
-    b = (b>>1) | 0x80; // shift in stop bit
-  }
-  _send_1(len); // stop bit (len is already bit_len)
+  softSerialPutWord((1 << 9) | (b << 1), 10, bit_len);
 }
 
 static void sendByteDsm2(uint8_t b)
@@ -71,20 +49,21 @@ static void sendByteDsm2(uint8_t b)
 
 void putDsm2Flush()
 {
-  if (extmodulePulsesData.dsm2.index & 1)
-    *extmodulePulsesData.dsm2.ptr++ = 255;
+  Dsm2PulsesData * frame = softSerialFrame();
+  if (frame->index & 1)
+    *frame->ptr++ = 255;
   else
-    *(extmodulePulsesData.dsm2.ptr - 1) = 255;
+    *(frame->ptr - 1) = 255;
 }
 
 // This is the data stream to send, prepare after 19.5 mS
 // Send after 22.5 mS
 
-void setupPulsesDSM2()
+static void setupPulsesDSM2()
 {
   uint8_t dsmDat[14];
 
-  reset_dsm2_buffer();
+  softSerialResetFrame();
 
   switch (moduleState[EXTERNAL_MODULE].protocol) {
     case PROTOCOL_CHANNELS_DSM2_LP45:
@@ -109,7 +88,7 @@ void setupPulsesDSM2()
 
   for (int i=0; i<DSM2_CHANS; i++) {
     int channel = g_model.moduleData[EXTERNAL_MODULE].channelsStart+i;
-    int value = channelOutputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+    int value = getChannelOutput(channel);
     uint16_t pulse = limit(0, ((value*13)>>5)+512, 1023);
     dsmDat[2+2*i] = (i<<2) | ((pulse>>8)&0x03);
     dsmDat[3+2*i] = pulse & 0xff;
@@ -129,11 +108,11 @@ static void sendByteDSMP(uint8_t b)
   _sendByte(b, BITLEN_DSMP);
 }
 
-void setupPulsesLemonDSMP()
+static void setupPulsesLemonDSMP()
 {
   static uint8_t pass = 0;
 
-  reset_dsm2_buffer();
+  softSerialResetFrame();
 
   const auto& md = g_model.moduleData[EXTERNAL_MODULE];
 
@@ -182,7 +161,7 @@ void setupPulsesLemonDSMP()
       if (current_channel < channels) {
         
         uint8_t channel = start_channel + current_channel;
-        int value = channelOutputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+        int value = getChannelOutput(channel);
         uint16_t pulse;
 
         // Use 11-bit ?
@@ -219,3 +198,62 @@ void setupPulsesLemonDSMP()
     moduleState[EXTERNAL_MODULE].counter = 100;
   }
 }
+
+static void* dsm2Init(uint8_t module)
+{
+  (void)module;
+  extmoduleSerialStart();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, DSM2_PERIOD);
+  return nullptr;
+}
+
+static void* dsmpInit(uint8_t module)
+{
+  (void)module;
+  extmoduleSerialStart();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 11 * 1000 /* 11ms in us */);
+  return nullptr;
+}
+
+static void dsm2DeInit(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void dsm2SetupPulses(void* context, int16_t* channels, uint8_t nChannels)
+{
+  (void)context;
+  setupPulsesDSM2();
+}
+
+static void dsmpSetupPulses(void* context, int16_t* channels, uint8_t nChannels)
+{
+  (void)context;
+  setupPulsesLemonDSMP();
+}
+
+static void dsm2SendPulses(void* context)
+{
+  (void)context;
+  softSerialSendFrame(true);
+}
+
+// LP45, DSM2 and DSMX share the same driver,
+// the variant is taken from the module state
+const etx_module_driver_t Dsm2ExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_DSM2_DSM2,
+  .init = dsm2Init,
+  .deinit = dsm2DeInit,
+  .setupPulses = dsm2SetupPulses,
+  .sendPulses = dsm2SendPulses,
+};
+
+const etx_module_driver_t DsmpExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_DSMP,
+  .init = dsmpInit,
+  .deinit = dsm2DeInit,
+  .setupPulses = dsmpSetupPulses,
+  .sendPulses = dsm2SendPulses,
+};
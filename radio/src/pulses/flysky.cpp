@@ -25,6 +25,7 @@
 
 #include "flysky.h"
 #include "telemetry/flysky_nv14.h"
+#include "channels_encoding.h"
 
 #define IS_VALID_COMMAND_ID(id) ((id) < CMD_LAST)
 
@@ -333,7 +334,7 @@ inline void putFlySkySendChannelData()
         pulseValue = 0xfff;
       } else {
         int16_t failsafeValue =
-            -1024 + 2 * PPM_CH_CENTER(channel) - 2 * PPM_CENTER;
+            -1024 + getChannelCenterOffset(channel);
         pulseValue =
             limit<uint16_t>(0, 988 + ((failsafeValue + 1024) / 2), 0xfff);
       }
@@ -347,8 +348,7 @@ inline void putFlySkySendChannelData()
     putFlySkyFrameByte(FLYSKY_CHANNEL_DATA_NORMAL);
     putFlySkyFrameByte(channels_last - channels_start);
     for (uint8_t channel = channels_start; channel < channels_last; channel++) {
-      int channelValue =
-          channelOutputs[channel] + 2 * PPM_CH_CENTER(channel) - 2 * PPM_CENTER;
+      int channelValue = getChannelOutput(channel);
       pulseValue = limit<uint16_t>(0, 988 + ((channelValue + 1024) / 2), 0xfff);
       putFlySkyFrameByte(pulseValue & 0xff);
       putFlySkyFrameByte(pulseValue >> 8);
@@ -20,6 +20,9 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
+#include "channels_encoding.h"
+#include "extmodule_driver.h"
 
 uint8_t createGhostMenuControlFrame(uint8_t * frame, int16_t * pulses)
 {
@@ -87,9 +90,9 @@ uint8_t createGhostChannelsFrame(uint8_t * frame, int16_t * pulses, bool raw12bi
   for (int i = 0; i < 4; i++) {
     uint32_t value;
     if(raw12bits) {
-      value = limit(0, (1024 + (pulses[i] + 2 * PPM_CH_CENTER(i) - 2 * PPM_CENTER)) << 1, 0xFFF);
+      value = limit(0, (1024 + (pulses[i] + getChannelCenterOffset(i))) << 1, 0xFFF);
     } else {
-      value = limit(0, GHST_RC_CTR_VAL_12BIT + (((pulses[i] + 2 * PPM_CH_CENTER(i) - 2 * PPM_CENTER) << 3) / 5), 2 * GHST_RC_CTR_VAL_12BIT);
+      value = limit(0, GHST_RC_CTR_VAL_12BIT + (((pulses[i] + getChannelCenterOffset(i)) << 3) / 5), 2 * GHST_RC_CTR_VAL_12BIT);
     }
     bits |= value << bitsavailable;
     bitsavailable += GHST_CH_BITS_12;
@@ -105,9 +108,9 @@ uint8_t createGhostChannelsFrame(uint8_t * frame, int16_t * pulses, bool raw12bi
     uint8_t channelIndex = i + ghostUpper4Offset;
     uint8_t value;
     if(raw12bits) {
-      value = limit(0, 128 + ((pulses[channelIndex] + 2 * PPM_CH_CENTER(channelIndex) - 2 * PPM_CENTER) >> 3), 0xFF);
+      value = limit(0, 128 + ((pulses[channelIndex] + getChannelCenterOffset(channelIndex)) >> 3), 0xFF);
     } else {
-      value = limit(0, GHST_RC_CTR_VAL_8BIT + (((pulses[channelIndex] + 2 * PPM_CH_CENTER(channelIndex) - 2 * PPM_CENTER) >> 1) / 5), 2 * GHST_RC_CTR_VAL_8BIT);
+      value = limit(0, GHST_RC_CTR_VAL_8BIT + (((pulses[channelIndex] + getChannelCenterOffset(channelIndex)) >> 1) / 5), 2 * GHST_RC_CTR_VAL_8BIT);
     }
     *buf++ = value;
   }
@@ -123,7 +126,7 @@ void setupPulsesGhost()
   if (telemetryProtocol == PROTOCOL_TELEMETRY_GHOST) {
 
     auto &module = g_model.moduleData[EXTERNAL_MODULE];
-    auto *p_data = &extmodulePulsesData.ghost;
+    auto *p_data = extmodulePulsesData.ghost.frame();
 
     #if defined(LUA)
     if (outputTelemetryBuffer.destination == TELEMETRY_ENDPOINT_SPORT) {
@@ -140,3 +143,51 @@ void setupPulsesGhost()
     moduleState[EXTERNAL_MODULE].counter = GHST_FRAME_CHANNEL;
   }
 }
+
+static void* ghostInit(uint8_t module)
+{
+  (void)module;
+  EXTERNAL_MODULE_ON();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, GHOST_PERIOD);
+  return nullptr;
+}
+
+static void ghostDeInit(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void ghostSetupPulses(void* context, int16_t* channels, uint8_t nChannels)
+{
+  (void)context;
+
+  ModuleSyncStatus& status = getModuleSyncStatus(EXTERNAL_MODULE);
+  if (status.isValid())
+    mixerSchedulerSetPeriod(EXTERNAL_MODULE, status.getAdjustedRefreshRate());
+  else
+    mixerSchedulerSetPeriod(EXTERNAL_MODULE, GHOST_PERIOD);
+
+  // nothing is built until the telemetry protocol is switched to Ghost
+  extmodulePulsesData.ghost.frame()->length = 0;
+  setupPulsesGhost();
+}
+
+static void ghostSendPulses(void* context)
+{
+  (void)context;
+  auto frame = extmodulePulsesData.ghost.frame();
+  if (frame->length > 0) {
+    sportSendBuffer(frame->pulses, frame->length);
+    extmodulePulsesData.ghost.swap();
+  }
+}
+
+const etx_module_driver_t GhostExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_GHOST,
+  .init = ghostInit,
+  .deinit = ghostDeInit,
+  .setupPulses = ghostSetupPulses,
+  .sendPulses = ghostSendPulses,
+};
@@ -25,6 +25,7 @@
 #include "io/multi_protolist.h"
 #include "telemetry/multi.h"
 #include "mixer_scheduler.h"
+#include "channels_encoding.h"
 
 // for the  MULTI protocol definition
 // see https://github.com/pascallanger/DIY-Multiprotocol-TX-Module
@@ -88,10 +89,18 @@ static void updateMultiSync(uint8_t module)
   }
 }
 
+static void sendChannelsValues(uint8_t moduleIdx, const uint16_t * values)
+{
+  uint8_t bytes[MULTI_CHANS * MULTI_CHAN_BITS / 8];
+  packChannels11Bits(bytes, values, MULTI_CHANS);
+  for (uint8_t b: bytes) {
+    sendMulti(moduleIdx, b);
+  }
+}
+
 static void sendFailsafeChannels(uint8_t moduleIdx)
 {
-  uint32_t bits = 0;
-  uint8_t bitsavailable = 0;
+  uint16_t values[MULTI_CHANS];
 
   for (int i = 0; i < MULTI_CHANS; i++) {
     int16_t failsafeValue = g_model.failsafeChannels[i];
@@ -104,18 +113,14 @@ static void sendFailsafeChannels(uint8_t moduleIdx)
       pulseValue = 0;
     }
     else {
-      failsafeValue += 2 * PPM_CH_CENTER(g_model.moduleData[moduleIdx].channelsStart + i) - 2 * PPM_CENTER;
+      failsafeValue += getChannelCenterOffset(g_model.moduleData[moduleIdx].channelsStart + i);
       pulseValue = limit(1, (failsafeValue * 800 / 1000) + 1024, 2046);
     }
 
-    bits |= pulseValue << bitsavailable;
-    bitsavailable += MULTI_CHAN_BITS;
-    while (bitsavailable >= 8) {
-      sendMulti(moduleIdx, (uint8_t) (bits & 0xff));
-      bits >>= 8;
-      bitsavailable -= 8;
-    }
+    values[i] = pulseValue;
   }
+
+  sendChannelsValues(moduleIdx, values);
 }
 
 void setupPulsesMulti(uint8_t moduleIdx)
@@ -208,13 +213,61 @@ void setupPulsesMulti(uint8_t moduleIdx)
 
 void setupPulsesMultiExternalModule()
 {
-  extmodulePulsesData.dsm2.index = 0;
-  extmodulePulsesData.dsm2.ptr = extmodulePulsesData.dsm2.pulses;
+  softSerialResetFrame();
 
   setupPulsesMulti(EXTERNAL_MODULE);
   putDsm2Flush();
 }
 
+#if defined(HARDWARE_EXTERNAL_MODULE)
+#include "extmodule_driver.h"
+
+static void* multiExternalInit(uint8_t module)
+{
+  (void)module;
+  extmoduleSerialStart();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, MULTIMODULE_PERIOD);
+
+  // reset status
+  getMultiModuleStatus(EXTERNAL_MODULE).failsafeChecked = false;
+  getMultiModuleStatus(EXTERNAL_MODULE).flags = 0;
+
+#if defined(MULTI_PROTOLIST)
+  MultiRfProtocols::instance(EXTERNAL_MODULE)->triggerScan();
+#endif
+
+  return nullptr;
+}
+
+static void multiExternalDeInit(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void multiExternalSetupPulses(void* context, int16_t* channels,
+                                     uint8_t nChannels)
+{
+  (void)context;
+  setupPulsesMultiExternalModule();
+}
+
+static void multiExternalSendPulses(void* context)
+{
+  (void)context;
+  softSerialSendFrame(true);
+}
+
+const etx_module_driver_t MultiExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_MULTIMODULE,
+  .init = multiExternalInit,
+  .deinit = multiExternalDeInit,
+  .setupPulses = multiExternalSetupPulses,
+  .sendPulses = multiExternalSendPulses,
+};
+#endif
+
 #if defined(INTERNAL_MODULE_MULTI)
 static void* multiInit(uint8_t module)
 {
@@ -279,28 +332,21 @@ const etx_module_driver_t MultiInternalDriver = {
 
 void sendChannels(uint8_t moduleIdx)
 {
-  uint32_t bits = 0;
-  uint8_t bitsavailable = 0;
+  uint16_t values[MULTI_CHANS];
 
   // byte 4-25, channels 0..2047
   // Range for pulses (channelsOutputs) is [-1024:+1024] for [-100%;100%]
   // Multi uses [204;1843] as [-100%;100%]
   for (int i = 0; i < MULTI_CHANS; i++) {
     int channel = g_model.moduleData[moduleIdx].channelsStart + i;
-    int value = channelOutputs[channel] + 2 * PPM_CH_CENTER(channel) - 2 * PPM_CENTER;
+    int value = getChannelOutput(channel);
 
     // Scale to 80%
     value = value * 800 / 1000 + 1024;
-    value = limit(0, value, 2047);
-
-    bits |= value << bitsavailable;
-    bitsavailable += MULTI_CHAN_BITS;
-    while (bitsavailable >= 8) {
-      sendMulti(moduleIdx, (uint8_t) (bits & 0xff));
-      bits >>= 8;
-      bitsavailable -= 8;
-    }
+    values[i] = limit(0, value, 2047);
   }
+
+  sendChannelsValues(moduleIdx, values);
 }
 
 void convertMultiProtocolToEtx(int *protocol, int *subprotocol)
@@ -20,6 +20,7 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
 
 // Minimum space after the last PPM pulse in us
 #define PPM_SAFE_MARGIN 3000 // 3ms
@@ -86,10 +87,10 @@ static void setupPulsesPPMModule(uint8_t module)
   } else
 #endif
   {
-    data = &extmodulePulsesData.ppm;
+    data = extmodulePulsesData.ppm.frame();
   }
 
-  setupPulsesPPM(&extmodulePulsesData.ppm,
+  setupPulsesPPM(data,
                  g_model.moduleData[module].channelsStart,
                  g_model.moduleData[module].channelsCount);
 
@@ -109,3 +110,50 @@ void setupPulsesPPMExternalModule()
 {
   setupPulsesPPMModule(EXTERNAL_MODULE);
 }
+
+#if defined(PPM) && defined(HARDWARE_EXTERNAL_MODULE)
+#include "extmodule_driver.h"
+
+static void* ppmInit(uint8_t module)
+{
+  (void)module;
+  extmodulePpmStart(GET_MODULE_PPM_DELAY(EXTERNAL_MODULE),
+                    GET_MODULE_PPM_POLARITY(EXTERNAL_MODULE));
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, PPM_PERIOD(EXTERNAL_MODULE));
+  return nullptr;
+}
+
+static void ppmDeInit(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void ppmSetupPulses(void* context, int16_t* channels, uint8_t nChannels)
+{
+  (void)context;
+  setupPulsesPPMExternalModule();
+}
+
+static void ppmSendPulses(void* context)
+{
+  (void)context;
+  auto frame = extmodulePulsesData.ppm.frame();
+  if (extmoduleSendNextFramePpm(frame->pulses, frame->ptr - frame->pulses,
+                                GET_MODULE_PPM_DELAY(EXTERNAL_MODULE),
+                                GET_MODULE_PPM_POLARITY(EXTERNAL_MODULE))) {
+    extmodulePulsesData.ppm.swap();
+  }
+  // PPM_PERIOD is not a constant! It depends on the channels count
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, PPM_PERIOD(EXTERNAL_MODULE));
+}
+
+const etx_module_driver_t PpmExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_PPM,
+  .init = ppmInit,
+  .deinit = ppmDeInit,
+  .setupPulses = ppmSetupPulses,
+  .sendPulses = ppmSendPulses,
+};
+#endif
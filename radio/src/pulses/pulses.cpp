@@ -22,6 +22,7 @@
 #include "opentx.h"
 #include "mixer_scheduler.h"
 #include "heartbeat_driver.h"
+#include "channels_encoding.h"
 
 #include "io/frsky_pxx2.h"
 #include "pulses/pxx2.h"
@@ -92,20 +93,45 @@ void restartModule(uint8_t idx)
     return;
   }
 
-  pauseMixerCalculations();
-  pausePulses();
+  requestModuleRestart(idx, MODULE_RESTART_OFF_TIME);
+}
 
+void requestModuleRestart(uint8_t idx, uint8_t offTime)
+{
   if (idx == INTERNAL_MODULE) INTERNAL_MODULE_OFF();
   else EXTERNAL_MODULE_OFF();
 
-  RTOS_WAIT_MS(20); // 20ms so that the pulses interrupt will reinit the frame rate
-  telemetryProtocol = 255; // force telemetry port + module reinitialization
+  // picked up by the mixer task in checkModuleRestart(): the release
+  // store makes the time visible before the request
+  moduleState[idx].restartTime = get_tmr10ms();
+  __atomic_store_n(&moduleState[idx].restartRequest, offTime, __ATOMIC_RELEASE);
+}
+
+// Returns true while the module has to be kept stopped: the current
+// protocol is stopped on the next mixer cycle, and started again
+// (which powers the module on) once it has been off long enough
+static bool checkModuleRestart(uint8_t idx)
+{
+  ModuleState& state = moduleState[idx];
+
+  // a request made meanwhile is not lost, it is taken on the next cycle
+  uint8_t request = __atomic_exchange_n(&state.restartRequest, 0, __ATOMIC_ACQUIRE);
+  if (request) {
+    state.restartDelay = request;
+    state.restartStart = state.restartTime;
+  }
 
-  if (idx == INTERNAL_MODULE) INTERNAL_MODULE_ON();
-  else EXTERNAL_MODULE_ON();
+  if (state.restartDelay) {
+    tmr10ms_t elapsed = get_tmr10ms() - state.restartStart;
+    if (elapsed < state.restartDelay) {
+      return true;
+    }
+    TRACE("Module %d restarted after %dms", idx, elapsed * 10);
+    state.restartDelay = 0;
+    telemetryProtocol = 255; // force telemetry port + module reinitialization
+  }
 
-  resumePulses();
-  resumeMixerCalculations();
+  return false;
 }
 
 // use only for PXX
@@ -497,6 +523,9 @@ void intmoduleSendNextFrame()
 bool setupPulsesInternalModule()
 {
   uint8_t protocol = getRequiredProtocol(INTERNAL_MODULE);
+  if (checkModuleRestart(INTERNAL_MODULE)) {
+    protocol = PROTOCOL_CHANNELS_NONE;
+  }
 
   heartbeat |= (HEART_TIMER_PULSES << INTERNAL_MODULE);
 
@@ -512,6 +541,56 @@ bool setupPulsesInternalModule()
 #endif
 
 #if defined(HARDWARE_EXTERNAL_MODULE)
+#if defined(AFHDS3)
+// afhds3.cpp does not include the firmware headers,
+// its driver is therefore kept here
+static void* afhds3Init(uint8_t module)
+{
+  (void)module;
+  extmodulePulsesData.afhds3.init(EXTERNAL_MODULE);
+  extmoduleSerialStart();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE,
+                          AFHDS3_COMMAND_TIMEOUT * 1000 /* us */);
+  return nullptr;
+}
+
+static void afhds3DeInit(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void afhds3SetupPulses(void* context, int16_t* channels,
+                              uint8_t nChannels)
+{
+  (void)context;
+  extmodulePulsesData.afhds3.setupFrame();
+}
+
+// Single buffered: the frame is part of the protocol state
+static void afhds3SendPulses(void* context)
+{
+  (void)context;
+#if defined(EXTMODULE_USART) && defined(EXTMODULE_TX_INVERT_GPIO)
+  extmoduleSendBuffer(extmodulePulsesData.afhds3.getData(),
+                      extmodulePulsesData.afhds3.getSize());
+#else
+  extmoduleSendNextFrameSoftSerial(extmodulePulsesData.afhds3.getData(),
+                                   extmodulePulsesData.afhds3.getSize(),
+                                   false);
+#endif
+}
+
+const etx_module_driver_t Afhds3ExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_AFHDS3,
+  .init = afhds3Init,
+  .deinit = afhds3DeInit,
+  .setupPulses = afhds3SetupPulses,
+  .sendPulses = afhds3SendPulses,
+};
+#endif
+
 static void* externalModuleContext = nullptr;
 static const etx_module_driver_t* externalModuleDriver = nullptr;
 
@@ -529,8 +608,8 @@ void enablePulsesExternalModule(uint8_t protocol)
   switch (protocol) {
 #if defined(PXX1)
     case PROTOCOL_CHANNELS_PXX1_PULSES:
-      extmodulePxx1PulsesStart();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, PXX_PULSES_PERIOD);
+      externalModuleContext = Pxx1ExternalPulsesDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &Pxx1ExternalPulsesDriver;
       break;
 #endif
 
@@ -545,8 +624,8 @@ void enablePulsesExternalModule(uint8_t protocol)
     case PROTOCOL_CHANNELS_DSM2_LP45:
     case PROTOCOL_CHANNELS_DSM2_DSM2:
     case PROTOCOL_CHANNELS_DSM2_DSMX:
-      extmoduleSerialStart();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, DSM2_PERIOD);
+      externalModuleContext = Dsm2ExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &Dsm2ExternalDriver;
       break;
 #endif
 
@@ -559,8 +638,8 @@ void enablePulsesExternalModule(uint8_t protocol)
 
 #if defined(GHOST)
     case PROTOCOL_CHANNELS_GHOST:
-      EXTERNAL_MODULE_ON();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, GHOST_PERIOD);
+      externalModuleContext = GhostExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &GhostExternalDriver;
       break;
 #endif
 
@@ -578,44 +657,35 @@ void enablePulsesExternalModule(uint8_t protocol)
 
 #if defined(MULTIMODULE)
     case PROTOCOL_CHANNELS_MULTIMODULE:
-      extmoduleSerialStart();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, MULTIMODULE_PERIOD);
-      getMultiModuleStatus(EXTERNAL_MODULE).failsafeChecked = false;
-      getMultiModuleStatus(EXTERNAL_MODULE).flags = 0;
-#if defined(MULTI_PROTOLIST)
-      MultiRfProtocols::instance(EXTERNAL_MODULE)->triggerScan();
-#endif
+      externalModuleContext = MultiExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &MultiExternalDriver;
       break;
 #endif
 
 #if defined(SBUS)
     case PROTOCOL_CHANNELS_SBUS:
-      extmoduleSerialStart();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, SBUS_PERIOD);
+      externalModuleContext = SbusExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &SbusExternalDriver;
       break;
 #endif
 
 #if defined(PPM)
     case PROTOCOL_CHANNELS_PPM:
-      extmodulePpmStart(
-          GET_MODULE_PPM_DELAY(EXTERNAL_MODULE),
-          GET_MODULE_PPM_POLARITY(EXTERNAL_MODULE));
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, PPM_PERIOD(EXTERNAL_MODULE));
+      externalModuleContext = PpmExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &PpmExternalDriver;
       break;
 #endif
 
 #if defined(AFHDS3)
     case PROTOCOL_CHANNELS_AFHDS3:
-      // convert to serial module interface
-      extmodulePulsesData.afhds3.init(EXTERNAL_MODULE);
-      extmoduleSerialStart();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, AFHDS3_COMMAND_TIMEOUT * 1000 /* us */);
+      externalModuleContext = Afhds3ExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &Afhds3ExternalDriver;
       break;
 #endif
 
     case PROTOCOL_CHANNELS_DSMP:
-      extmoduleSerialStart();
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, 11 * 1000 /* 11ms in us */);
+      externalModuleContext = DsmpExternalDriver.init(EXTERNAL_MODULE);
+      externalModuleDriver = &DsmpExternalDriver;
       break;
       
     default:
@@ -625,152 +695,37 @@ void enablePulsesExternalModule(uint8_t protocol)
   }
 }
 
-bool setupPulsesExternalModule(uint8_t protocol)
+static bool setupPulsesExternalModuleDriver()
 {
+  if (!externalModuleDriver)
+    return false;
+
   uint8_t channelStart = g_model.moduleData[EXTERNAL_MODULE].channelsStart;
   int16_t* channels = &channelOutputs[channelStart];
   uint8_t nChannels = 16;  // TODO: MAX_CHANNELS - channelsStart
 
-  if (externalModuleDriver) {
-    externalModuleDriver->setupPulses(externalModuleContext,
-                                      channels, nChannels);
-    return true;
-  }
-  
-  switch (protocol) {
-
-#if defined(PXX1)
-    case PROTOCOL_CHANNELS_PXX1_PULSES:
-      extmodulePulsesData.pxx.setupFrame(EXTERNAL_MODULE);
-      return true;
-#endif
-
-#if defined(SBUS)
-    case PROTOCOL_CHANNELS_SBUS:
-      setupPulsesSbus();
-      // SBUS_PERIOD is not a constant! It can be set from UI
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, SBUS_PERIOD);
-      return true;
-#endif
-
-#if defined(DSM2)
-    case PROTOCOL_CHANNELS_DSM2_LP45:
-    case PROTOCOL_CHANNELS_DSM2_DSM2:
-    case PROTOCOL_CHANNELS_DSM2_DSMX:
-      setupPulsesDSM2();
-      return true;
-#endif
-
-#if defined(GHOST)
-    case PROTOCOL_CHANNELS_GHOST:
-    {
-      ModuleSyncStatus& status = getModuleSyncStatus(EXTERNAL_MODULE);
-      if (status.isValid())
-        mixerSchedulerSetPeriod(EXTERNAL_MODULE, status.getAdjustedRefreshRate());
-      else
-        mixerSchedulerSetPeriod(EXTERNAL_MODULE, GHOST_PERIOD);
-      setupPulsesGhost();
-      return true;
-    }
-#endif
-
-#if defined(MULTIMODULE)
-    case PROTOCOL_CHANNELS_MULTIMODULE:
-      setupPulsesMultiExternalModule();
-      return true;
-#endif
-
-#if defined(PPM)
-    case PROTOCOL_CHANNELS_PPM:
-      setupPulsesPPMExternalModule();
-      return true;
-#endif
-
-#if defined(AFHDS3)
-    case PROTOCOL_CHANNELS_AFHDS3:
-      extmodulePulsesData.afhds3.setupFrame();
-      return true;
-#endif
-
-    case PROTOCOL_CHANNELS_DSMP:
-      setupPulsesLemonDSMP();
-      return true;
-
-    default:
-      return false;
-  }
+  externalModuleDriver->setupPulses(externalModuleContext,
+                                    channels, nChannels);
+  return true;
 }
 
 void extmoduleSendNextFrame()
 {
   if (externalModuleDriver) {
     externalModuleDriver->sendPulses(externalModuleContext);
-    return;
   }
+}
 
-  switch (moduleState[EXTERNAL_MODULE].protocol) {
-
-    case PROTOCOL_CHANNELS_PPM:
-      extmoduleSendNextFramePpm(
-          extmodulePulsesData.ppm.pulses,
-          extmodulePulsesData.ppm.ptr - extmodulePulsesData.ppm.pulses,
-          GET_MODULE_PPM_DELAY(EXTERNAL_MODULE),
-          GET_MODULE_PPM_POLARITY(EXTERNAL_MODULE));
-      mixerSchedulerSetPeriod(EXTERNAL_MODULE, PPM_PERIOD(EXTERNAL_MODULE));
-      break;
-
-#if defined(PXX1)
-    case PROTOCOL_CHANNELS_PXX1_PULSES:
-      extmoduleSendNextFramePxx1(extmodulePulsesData.pxx.getData(),
-                                 extmodulePulsesData.pxx.getSize());
-      break;
-#endif
-
-#if defined(AFHDS3)
-    case PROTOCOL_CHANNELS_AFHDS3:
-#if defined(EXTMODULE_USART) && defined(EXTMODULE_TX_INVERT_GPIO)
-      extmoduleSendBuffer(extmodulePulsesData.afhds3.getData(),
-                          extmodulePulsesData.afhds3.getSize());
-#else
-      extmoduleSendNextFrameSoftSerial(extmodulePulsesData.afhds3.getData(),
-                                       extmodulePulsesData.afhds3.getSize(),
-                                       false);
-#endif
-      break;
-#endif
-
-#if defined(SBUS) || defined(DSM2) || defined(MULTIMODULE)
-    case PROTOCOL_CHANNELS_SBUS:
-      extmoduleSendNextFrameSoftSerial(
-          extmodulePulsesData.dsm2.pulses,
-          extmodulePulsesData.dsm2.ptr - extmodulePulsesData.dsm2.pulses,
-          GET_SBUS_POLARITY(EXTERNAL_MODULE));
-      break;
-
-    case PROTOCOL_CHANNELS_DSM2_LP45:
-    case PROTOCOL_CHANNELS_DSM2_DSM2:
-    case PROTOCOL_CHANNELS_DSM2_DSMX:
-    case PROTOCOL_CHANNELS_MULTIMODULE:
-      extmoduleSendNextFrameSoftSerial(
-          extmodulePulsesData.dsm2.pulses,
-          extmodulePulsesData.dsm2.ptr - extmodulePulsesData.dsm2.pulses);
-      break;
-#endif
-    case PROTOCOL_CHANNELS_DSMP:
-      extmoduleSendNextFrameSoftSerial(
-          extmodulePulsesData.dsm2.pulses,
-          extmodulePulsesData.dsm2.ptr - extmodulePulsesData.dsm2.pulses,
-          true);
-      break;
-
-#if defined(GHOST)
-    case PROTOCOL_CHANNELS_GHOST:
-      sportSendBuffer(extmodulePulsesData.ghost.pulses,
-                      extmodulePulsesData.ghost.length);
-      break;
-#endif
+#if defined(DSM2) || defined(MULTIMODULE) || defined(SBUS)
+void softSerialSendFrame(bool polarity)
+{
+  Dsm2PulsesData * frame = softSerialFrame();
+  if (extmoduleSendNextFrameSoftSerial(frame->pulses,
+                                       frame->ptr - frame->pulses, polarity)) {
+    extmodulePulsesData.dsm2.swap();
   }
 }
+#endif
 
 void stopPulsesExternalModule()
 {
@@ -791,6 +746,9 @@ void stopPulsesExternalModule()
 bool setupPulsesExternalModule()
 {
   uint8_t protocol = getRequiredProtocol(EXTERNAL_MODULE);
+  if (checkModuleRestart(EXTERNAL_MODULE)) {
+    protocol = PROTOCOL_CHANNELS_NONE;
+  }
 
   heartbeat |= (HEART_TIMER_PULSES << EXTERNAL_MODULE);
 
@@ -800,7 +758,7 @@ bool setupPulsesExternalModule()
     return false;
   }
   else {
-    return setupPulsesExternalModule(protocol);
+    return setupPulsesExternalModuleDriver();
   }
 }
 #endif
@@ -822,5 +780,5 @@ void setCustomFailsafe(uint8_t moduleIndex)
 
 int32_t getChannelValue(uint8_t channel)
 {
-  return channelOutputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+  return getChannelOutput(channel);
 }
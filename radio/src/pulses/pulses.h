@@ -23,6 +23,7 @@
 #define _PULSES_H_
 
 #include "definitions.h"
+#include "opentx_types.h"
 #include "dataconstants.h"
 #include "pulses_common.h"
 #include "pxx1.h"
@@ -73,6 +74,14 @@ PACK(struct ModuleState {
   uint8_t spare:3;
   uint16_t counter;
 
+  // Restart handled by the mixer task (10ms units): time and off time
+  // of the last request, published by requestModuleRestart() (time
+  // first), then off time and start of the ongoing restart
+  tmr10ms_t restartTime;
+  uint8_t restartRequest;
+  uint8_t restartDelay;
+  tmr10ms_t restartStart;
+
   // PXX specific items
   union
   {
@@ -110,13 +119,38 @@ template<class T> struct PpmPulsesData {
 };
 
 #define MAX_PULSES_TRANSITIONS 300
-PACK(struct Dsm2TimerPulsesData {
+struct Dsm2TimerPulsesData {
   pulse_duration_t pulses[MAX_PULSES_TRANSITIONS];
   pulse_duration_t * ptr;
   uint8_t index;
-});
+};
 typedef Dsm2TimerPulsesData Dsm2PulsesData;
 
+// External module frames are double buffered: the mixer task builds the
+// next frame while the DMA still sends the previous one
+// (not packed: both frames have to stay aligned for the DMA)
+template <class T>
+struct DoubleBufferedPulses {
+  T frames[2];
+  uint8_t next;
+
+  // Frame currently being built ('next' is not reset when the
+  // union is taken over by another protocol, only its low bit is used)
+  T * frame()
+  {
+    return &frames[next & 1];
+  }
+
+  // To be called once the frame built is being sent
+  void swap()
+  {
+    next ^= 1;
+  }
+};
+
+// Soft serial frames (DSM2, SBUS, Multi, DSMP)
+typedef DoubleBufferedPulses<Dsm2PulsesData> SoftSerialPulsesData;
+
 #define PPM_DEF_PERIOD               225 /* 22.5ms */
 #define PPM_STEP_SIZE                5 /*0.5ms*/
 #define PPM_PERIOD_FL_TO_HALF_US(fl) (((fl)*PPM_STEP_SIZE+PPM_DEF_PERIOD)*200) /* half us*/
@@ -183,7 +217,7 @@ union ExternalModulePulsesData {
 #if defined(HARDWARE_EXTERNAL_MODULE_SIZE_SML)
   UartPxx1Pulses pxx_uart;
 #endif
-  PwmPxx1Pulses pxx;
+  DoubleBufferedPulses<PwmPxx1Pulses> pxx;
 #endif
 
 #if defined(PXX2)
@@ -191,21 +225,21 @@ union ExternalModulePulsesData {
 #endif
 
 #if defined(DSM2) || defined(MULTIMODULE) || defined(SBUS)
-  Dsm2PulsesData dsm2;
+  SoftSerialPulsesData dsm2;
 #endif
 
 #if defined(AFHDS3)
   afhds3::PulsesData afhds3;
 #endif
 
-  PpmPulsesData<pulse_duration_t> ppm;
+  DoubleBufferedPulses<PpmPulsesData<pulse_duration_t>> ppm;
 
 #if defined(CROSSFIRE)
   CrossfirePulsesData crossfire;
 #endif
 
 #if defined(GHOST)
-  GhostPulsesData ghost;
+  DoubleBufferedPulses<GhostPulsesData> ghost;
 #endif
 } __ALIGNED(4);
 
@@ -219,6 +253,48 @@ union ExternalModulePulsesData {
 extern InternalModulePulsesData intmodulePulsesData;
 extern ExternalModulePulsesData extmodulePulsesData;
 
+#if defined(DSM2) || defined(MULTIMODULE) || defined(SBUS)
+// Frame currently being built
+inline Dsm2PulsesData * softSerialFrame()
+{
+  return extmodulePulsesData.dsm2.frame();
+}
+
+inline void softSerialResetFrame()
+{
+  Dsm2PulsesData * frame = softSerialFrame();
+  frame->index = 0;
+  frame->ptr = frame->pulses;
+}
+
+// Appends a complete serial word (start, data, parity and stop bits, LSB
+// first) to the frame, one pulse per level change. The level changes are
+// found from the whole word at once instead of walking it bit by bit.
+// 'edgeComp' is removed from low levels and added to high levels.
+inline void softSerialPutWord(uint32_t word, uint8_t bits, uint8_t bitLen, uint8_t edgeComp = 0)
+{
+  Dsm2PulsesData * frame = softSerialFrame();
+  uint32_t last = 1u << (bits - 1);
+  uint32_t ends = ((word ^ (word >> 1)) & (last - 1)) | last;
+  uint8_t start = 0;
+  while (ends) {
+    uint8_t end = __builtin_ctz(ends) + 1;
+    uint8_t len = (end - start) * bitLen;
+    if (frame->index & 1)
+      len += edgeComp;
+    else
+      len -= edgeComp;
+    *frame->ptr++ = len - 1;
+    frame->index += 1;
+    start = end;
+    ends &= ends - 1;
+  }
+}
+
+// Sends the frame built and switches to the other buffer
+void softSerialSendFrame(bool polarity);
+#endif
+
 union TrainerPulsesData {
   PpmPulsesData<trainer_pulse_duration_t> ppm;
 };
@@ -235,13 +311,15 @@ bool setupPulsesExternalModule();
 void stopPulsesExternalModule();
 void extmoduleSendNextFrame();
 #endif
+// Minimum time a module is kept powered off when restarted (10ms units)
+#define MODULE_RESTART_OFF_TIME        2   // 20ms
+#define MODULE_RELOAD_OFF_TIME         20  // 200ms, when loading another model
+
 void restartModule(uint8_t idx);
-void setupPulsesDSM2();
-void setupPulsesLemonDSMP();
+void requestModuleRestart(uint8_t idx, uint8_t offTime);
 void setupPulsesCrossfire(uint8_t idx);
 void setupPulsesGhost();
 void setupPulsesMultiExternalModule();
-void setupPulsesSbus();
 void setupPulsesPPMInternalModule();
 void setupPulsesPPMExternalModule();
 void setupPulsesPPMTrainer();
@@ -262,6 +340,15 @@ uint8_t actualAfhdsRunPower(int moduleIndex);
 #endif
 void extramodulePpmStart();
 
+extern const etx_module_driver_t Dsm2ExternalDriver;
+extern const etx_module_driver_t DsmpExternalDriver;
+extern const etx_module_driver_t SbusExternalDriver;
+extern const etx_module_driver_t PpmExternalDriver;
+extern const etx_module_driver_t Pxx1ExternalPulsesDriver;
+extern const etx_module_driver_t GhostExternalDriver;
+extern const etx_module_driver_t MultiExternalDriver;
+extern const etx_module_driver_t Afhds3ExternalDriver;
+
 void startPulses();
 void stopPulses();
 
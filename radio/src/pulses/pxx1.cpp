@@ -23,6 +23,7 @@
 #include "pulses/pxx1.h"
 #include "mixer_scheduler.h"
 #include "heartbeat_driver.h"
+#include "channels_encoding.h"
 
 template <class PxxTransport>
 void Pxx1Pulses<PxxTransport>::addFlag1(uint8_t module, uint8_t sendFailsafe)
@@ -95,7 +96,7 @@ void Pxx1Pulses<PxxTransport>::addChannels(uint8_t moduleIdx, uint8_t sendFailsa
             pulseValue = 2048;
           }
           else {
-            failsafeValue += 2*PPM_CH_CENTER(8+g_model.moduleData[moduleIdx].channelsStart+i) - 2*PPM_CENTER;
+            failsafeValue += getChannelCenterOffset(8+g_model.moduleData[moduleIdx].channelsStart+i);
             pulseValue = limit(2049, (failsafeValue * 512 / 682) + 3072, 4094);
           }
         }
@@ -108,7 +109,7 @@ void Pxx1Pulses<PxxTransport>::addChannels(uint8_t moduleIdx, uint8_t sendFailsa
             pulseValue = 0;
           }
           else {
-            failsafeValue += 2*PPM_CH_CENTER(g_model.moduleData[moduleIdx].channelsStart+i) - 2*PPM_CENTER;
+            failsafeValue += getChannelCenterOffset(g_model.moduleData[moduleIdx].channelsStart+i);
             pulseValue = limit(1, (failsafeValue * 512 / 682) + 1024, 2046);
           }
         }
@@ -117,12 +118,12 @@ void Pxx1Pulses<PxxTransport>::addChannels(uint8_t moduleIdx, uint8_t sendFailsa
     else {
       if (i < sendUpperChannels) {
         int channel = 8 + g_model.moduleData[moduleIdx].channelsStart + i;
-        int value = channelOutputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+        int value = getChannelOutput(channel);
         pulseValue = limit(2049, (value * 512 / 682) + 3072, 4094);
       }
       else if (i < sentModulePXXChannels(moduleIdx)) {
         int channel = g_model.moduleData[moduleIdx].channelsStart + i;
-        int value = channelOutputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+        int value = getChannelOutput(channel);
         pulseValue = limit(1, (value * 512 / 682) + 1024, 2046);
       }
       else {
@@ -336,3 +337,46 @@ const etx_module_driver_t Pxx1ExternalSerialDriver = {
 };
 
 #endif
+
+#if defined(HARDWARE_EXTERNAL_MODULE)
+#include "extmodule_driver.h"
+
+static void* pxx1InitPwmExternal(uint8_t module)
+{
+  (void)module;
+  extmodulePxx1PulsesStart();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, PXX_PULSES_PERIOD);
+  return nullptr;
+}
+
+static void pxx1DeInitPwmExternal(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void pxx1SetupPulsesPwmExternal(void* context, int16_t* channels,
+                                       uint8_t nChannels)
+{
+  (void)context;
+  extmodulePulsesData.pxx.frame()->setupFrame(EXTERNAL_MODULE);
+}
+
+static void pxx1SendPulsesPwmExternal(void* context)
+{
+  (void)context;
+  auto frame = extmodulePulsesData.pxx.frame();
+  if (extmoduleSendNextFramePxx1(frame->getData(), frame->getSize())) {
+    extmodulePulsesData.pxx.swap();
+  }
+}
+
+const etx_module_driver_t Pxx1ExternalPulsesDriver = {
+  .protocol = PROTOCOL_CHANNELS_PXX1_PULSES,
+  .init = pxx1InitPwmExternal,
+  .deinit = pxx1DeInitPwmExternal,
+  .setupPulses = pxx1SetupPulsesPwmExternal,
+  .sendPulses = pxx1SendPulsesPwmExternal,
+};
+#endif
@@ -26,6 +26,7 @@
 #include "libopenui/src/libopenui_file.h"
 #include "mixer_scheduler.h"
 #include "heartbeat_driver.h"
+#include "channels_encoding.h"
 
 #if defined(INTMODULE_USART)
 #include "intmodule_serial_driver.h"
@@ -133,7 +134,7 @@ void Pxx2Pulses::addChannels(uint8_t module, int16_t* channels, uint8_t nChannel
   uint8_t count = sentModuleChannels(module);
 
   for (int8_t i = 0; i < count; i++, channel++) {
-    int value = channels[i] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+    int value = channels[i] + getChannelCenterOffset(channel);
     pulseValue = limit(1, (value * 512 / 682) + 1024, 2046);
 #if defined(DEBUG_LATENCY_RF_ONLY)
     if (latencyToggleSwitch)
@@ -172,7 +173,7 @@ void Pxx2Pulses::addFailsafe(uint8_t module)
         pulseValue = 0;
       }
       else {
-        failsafeValue += 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+        failsafeValue += getChannelCenterOffset(channel);
         pulseValue = limit(1, (failsafeValue * 512 / 682) + 1024, 2046);
       }
     }
@@ -20,6 +20,9 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
+#include "channels_encoding.h"
+#include "extmodule_driver.h"
 
 
 #define BITLEN_SBUS          (10*2) // 100000 Baud => 10uS per bit
@@ -28,41 +31,16 @@
 /* The protocol reuse some the DSM2 definitions where they are identical */
 
 
-static void _send_level(uint8_t v)
+// 4 bits parity lookup, 0x6996 = 0110 1001 1001 0110
+#define NIBBLE_PARITY(n)     ((0x6996 >> (n)) & 1)
+
+void sendByteSbus(uint8_t b) // 8E2: start bit, 8 data bits, even parity, 2 stop bits
 {
+  uint8_t parity = NIBBLE_PARITY((b ^ (b >> 4)) & 0x0F);
+
   /* Copied over from DSM, this looks doubious and in my logic analyzer
      output the low->high is about 2 ns late */
-  if (extmodulePulsesData.dsm2.index & 1)
-    v += 2;
-  else
-    v -= 2;
-
-  *extmodulePulsesData.dsm2.ptr++ = v - 1;
-  extmodulePulsesData.dsm2.index+=1;
-}
-
-void sendByteSbus(uint8_t b) // max 11 changes 0 10 10 10 10 P 1
-{
-  bool    lev = 0;
-  uint8_t parity = 1;
-
-  uint8_t len = BITLEN_SBUS; //max val: 10*20 < 256
-  for (uint8_t i=0; i<=9; i++) { //8Bits + 1Parity + Stop=1
-    bool nlev = b & 1; //lsb first
-    parity = parity ^ (uint8_t)nlev;
-    if (lev == nlev) {
-      len += BITLEN_SBUS;
-    }
-    else {
-      _send_level(len);
-      len  = BITLEN_SBUS;
-      lev  = nlev;
-    }
-    b = (b>>1) | 0x80; //shift in ones for stop bit and parity
-    if (i==7)
-      b = b ^ parity; // lowest bit is one from previous line
-  }
-  _send_level(len+ BITLEN_SBUS); // enlarge the last bit to be two stop bits long
+  softSerialPutWord((3 << 10) | (parity << 9) | (b << 1), 12, BITLEN_SBUS, 2);
 }
 
 
@@ -86,41 +64,36 @@ inline int getChannelValue(uint8_t port, int channel)
   // We will ignore 17 and 18th if that brings us over the limit
   if (ch > 31)
     return 0;
-  return channelOutputs[ch] + 2 * PPM_CH_CENTER(ch) - 2*PPM_CENTER;
+  return getChannelOutput(ch);
 }
 
 static void sbusFlush()
 {
-  if (extmodulePulsesData.dsm2.index & 1)
-    *extmodulePulsesData.dsm2.ptr++ = 255;
+  Dsm2PulsesData * frame = softSerialFrame();
+  if (frame->index & 1)
+    *frame->ptr++ = 255;
   else
-    *(extmodulePulsesData.dsm2.ptr - 1) = 255;
+    *(frame->ptr - 1) = 255;
 }
 
-void setupPulsesSbus()
+static void setupPulsesSbus()
 {
-  extmodulePulsesData.dsm2.index = 0;
-
-  extmodulePulsesData.dsm2.ptr = extmodulePulsesData.dsm2.pulses;
+  softSerialResetFrame();
 
   // Sync Byte
   sendByteSbus(SBUS_FRAME_BEGIN_BYTE);
 
-  uint32_t bits = 0;
-  uint8_t bitsavailable = 0;
-
   // byte 1-22, channels 0..2047, limits not really clear (B
+  uint16_t values[SBUS_NORMAL_CHANS];
   for (int i=0; i<SBUS_NORMAL_CHANS; i++) {
     int value = getChannelValue(EXTERNAL_MODULE, i);
+    values[i] = limit(0, value*8/10 + SBUS_CHAN_CENTER, 2047);
+  }
 
-    value =  value*8/10 + SBUS_CHAN_CENTER;
-    bits |= limit(0, value, 2047) << bitsavailable;
-    bitsavailable += SBUS_CHAN_BITS;
-    while (bitsavailable >= 8) {
-      sendByteSbus((uint8_t) (bits & 0xff));
-      bits >>= 8;
-      bitsavailable -= 8;
-    }
+  uint8_t bytes[SBUS_NORMAL_CHANS * SBUS_CHAN_BITS / 8];
+  packChannels11Bits(bytes, values, SBUS_NORMAL_CHANS);
+  for (uint8_t b: bytes) {
+    sendByteSbus(b);
   }
 
   // flags
@@ -137,3 +110,40 @@ void setupPulsesSbus()
 
   sbusFlush();
 }
+
+static void* sbusInit(uint8_t module)
+{
+  (void)module;
+  extmoduleSerialStart();
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, SBUS_PERIOD);
+  return nullptr;
+}
+
+static void sbusDeInit(void* context)
+{
+  (void)context;
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, 0);
+  extmoduleStop();
+}
+
+static void sbusSetupPulses(void* context, int16_t* channels, uint8_t nChannels)
+{
+  (void)context;
+  setupPulsesSbus();
+  // SBUS_PERIOD is not a constant! It can be set from UI
+  mixerSchedulerSetPeriod(EXTERNAL_MODULE, SBUS_PERIOD);
+}
+
+static void sbusSendPulses(void* context)
+{
+  (void)context;
+  softSerialSendFrame(GET_SBUS_POLARITY(EXTERNAL_MODULE));
+}
+
+const etx_module_driver_t SbusExternalDriver = {
+  .protocol = PROTOCOL_CHANNELS_SBUS,
+  .init = sbusInit,
+  .deinit = sbusDeInit,
+  .setupPulses = sbusSetupPulses,
+  .sendPulses = sbusSendPulses,
+};
@@ -32,6 +32,7 @@ extern "C++" {
 #if defined(SIMU)
   #include <pthread.h>
   #include <semaphore.h>
+  #include <time.h>
 
   #define SIMU_SLEEP_OR_EXIT_MS(x)       simuSleep(x)
   #define RTOS_MS_PER_TICK  1
@@ -39,7 +40,11 @@ extern "C++" {
   typedef pthread_t RTOS_TASK_HANDLE;
   typedef pthread_mutex_t RTOS_MUTEX_HANDLE;
 
-  typedef uint32_t RTOS_FLAG_HANDLE;
+  typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint8_t set;
+  } RTOS_FLAG_HANDLE;
 
   typedef sem_t * RTOS_EVENT_HANDLE;
 
@@ -76,6 +81,44 @@ extern "C++" {
       pthread_mutex_unlock(&mutex);
   }
 
+  static inline void RTOS_CREATE_FLAG(RTOS_FLAG_HANDLE &flag)
+  {
+    pthread_mutex_init(&flag.mutex, nullptr);
+    pthread_cond_init(&flag.cond, nullptr);
+    flag.set = 0;
+  }
+
+  static inline void RTOS_SET_FLAG(RTOS_FLAG_HANDLE &flag)
+  {
+    pthread_mutex_lock(&flag.mutex);
+    flag.set = 1;
+    pthread_cond_signal(&flag.cond);
+    pthread_mutex_unlock(&flag.mutex);
+  }
+
+  // returns true if timeout
+  static inline bool RTOS_WAIT_FLAG(RTOS_FLAG_HANDLE &flag, uint32_t timeout)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / 1000;
+    ts.tv_nsec += (timeout % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&flag.mutex);
+    while (!flag.set) {
+      if (pthread_cond_timedwait(&flag.cond, &flag.mutex, &ts))
+        break;
+    }
+    bool result = !flag.set;
+    flag.set = 0;
+    pthread_mutex_unlock(&flag.mutex);
+    return result;
+  }
+
   template<int SIZE>
   class FakeTaskStack
   {
@@ -242,10 +285,23 @@ inline void RTOS_CREATE_TASK(pthread_t &taskId, void * (*task)(void *), const ch
     return getStackAvailable(&_main_stack_start, stackSize());
   }
 
-  //#define RTOS_CREATE_FLAG(flag)        flag = CoCreateFlag(false, false)
-  //#define RTOS_SET_FLAG(flag)           (void)CoSetFlag(flag)
   //#define RTOS_CLEAR_FLAG(flag)         (void)CoClearFlag(flag)
 
+  static inline void _RTOS_CREATE_FLAG(RTOS_FLAG_HANDLE* flag)
+  {
+    // not given: the first wait blocks until the flag is set
+    flag->rtos_handle = xSemaphoreCreateBinaryStatic(&flag->mutex_struct);
+  }
+
+  #define RTOS_CREATE_FLAG(flag) _RTOS_CREATE_FLAG(&flag)
+
+  static inline void _RTOS_SET_FLAG(RTOS_FLAG_HANDLE* flag)
+  {
+    xSemaphoreGive(flag->rtos_handle);
+  }
+
+  #define RTOS_SET_FLAG(flag) _RTOS_SET_FLAG(&flag)
+
   // returns true if timeout
   static inline bool _RTOS_WAIT_FLAG(RTOS_FLAG_HANDLE* flag, uint32_t timeout)
   {
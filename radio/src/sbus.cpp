@@ -22,6 +22,7 @@
 #include "opentx.h"
 #include "sbus.h"
 #include "timers_driver.h"
+#include "pulses/channels_encoding.h"
 
 #define SBUS_FRAME_GAP_DELAY   1000 // 500uS
 
@@ -31,9 +32,6 @@
 #define SBUS_FRAMELOST_BIT     2
 #define SBUS_FAILSAFE_BIT      3
 
-#define SBUS_CH_BITS           11
-#define SBUS_CH_MASK           ((1<<SBUS_CH_BITS) - 1)
-
 #define SBUS_CH_CENTER         0x3E0
 
 static int (*_sbusAuxGetByte)(void*, uint8_t*) = nullptr;
@@ -60,72 +58,81 @@ int sbusAuxGetByte(uint8_t* byte)
 
 static int (*sbusGetByte)(uint8_t*) = nullptr;
 
+static uint8_t sbusFrame[SBUS_FRAME_SIZE];
+static uint8_t sbusIndex = 0;
+static uint16_t sbusTimer;
+
 void sbusSetGetByte(int (*fct)(uint8_t*))
 {
   sbusGetByte = fct;
+  sbusIndex = 0;
 }
 
 // Range for pulses (ppm input) is [-512:+512]
-void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
+static void processSbusFrame(const uint8_t * sbus, int16_t * pulses)
 {
-  if (size != SBUS_FRAME_SIZE || sbus[0] != SBUS_START_BYTE ||
-      sbus[SBUS_FRAME_SIZE - 1] != SBUS_END_BYTE) {
-    return;  // not a valid SBUS frame
-  }
   if ((sbus[SBUS_FLAGS_IDX] & (1 << SBUS_FAILSAFE_BIT)) ||
       (sbus[SBUS_FLAGS_IDX] & (1 << SBUS_FRAMELOST_BIT))) {
     return;  // SBUS invalid frame or failsafe mode
   }
 
-  sbus++; // skip start byte
+  uint16_t values[MAX_TRAINER_CHANNELS];
+  unpackChannels11Bits(sbus + 1, values, MAX_TRAINER_CHANNELS);
 
-  uint32_t inputbitsavailable = 0;
-  uint32_t inputbits = 0;
   for (uint32_t i=0; i<MAX_TRAINER_CHANNELS; i++) {
-    while (inputbitsavailable < SBUS_CH_BITS) {
-      inputbits |= *sbus++ << inputbitsavailable;
-      inputbitsavailable += 8;
-    }
-    *pulses++ = ((int32_t) (inputbits & SBUS_CH_MASK) - SBUS_CH_CENTER) * 5 / 8;
-    inputbitsavailable -= SBUS_CH_BITS;
-    inputbits >>= SBUS_CH_BITS;
+    pulses[i] = ((int32_t)values[i] - SBUS_CH_CENTER) * 5 / 8;
   }
 
   ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
 }
 
-void processSbusInput()
+// Drops the first byte of a full buffer that is not a frame, and
+// restarts from the next start byte found in what was received
+static void resyncSbusFrame()
 {
+  uint8_t i = 1;
+  while (i < SBUS_FRAME_SIZE && sbusFrame[i] != SBUS_START_BYTE) {
+    i++;
+  }
+  sbusIndex = SBUS_FRAME_SIZE - i;
+  memmove(sbusFrame, &sbusFrame[i], sbusIndex);
+}
 
-  // TODO: place this outside of the function
-  static uint8_t SbusIndex = 0;
-  static uint16_t SbusTimer;
-  static uint8_t SbusFrame[SBUS_FRAME_SIZE];
-
+void processSbusInput()
+{
   uint32_t active = 0;
 
-  // Drain input first (if existing)
+  // Frames are delimited by their start and end bytes, so a frame is
+  // decoded as soon as its last byte has arrived
   uint8_t rxchar;
   auto _getByte = sbusGetByte;
   while (_getByte && (_getByte(&rxchar) > 0)) {
     active = 1;
-    if (SbusIndex > SBUS_FRAME_SIZE - 1) {
-      SbusIndex = SBUS_FRAME_SIZE - 1;
+    if (sbusIndex == 0 && rxchar != SBUS_START_BYTE) {
+      continue;  // wait for a start byte
+    }
+    sbusFrame[sbusIndex++] = rxchar;
+    if (sbusIndex == SBUS_FRAME_SIZE) {
+      if (rxchar == SBUS_END_BYTE) {
+        processSbusFrame(sbusFrame, ppmInput);
+        sbusIndex = 0;
+      }
+      else {
+        resyncSbusFrame();
+      }
     }
-    SbusFrame[SbusIndex++] = rxchar;
   }
 
   // Data has been received
   if (active) {
-    SbusTimer = getTmr2MHz();
+    sbusTimer = getTmr2MHz();
     return;
   }
 
-  // Check if end-of-frame is detected
-  if (SbusIndex) {
-    if ((uint16_t)(getTmr2MHz() - SbusTimer) > SBUS_FRAME_GAP_DELAY) {
-      processSbusFrame(SbusFrame, ppmInput, SbusIndex);
-      SbusIndex = 0;
+  // A gap in the stream drops any partial frame
+  if (sbusIndex) {
+    if ((uint16_t)(getTmr2MHz() - sbusTimer) > SBUS_FRAME_GAP_DELAY) {
+      sbusIndex = 0;
     }
   }
 }
@@ -213,14 +213,162 @@ const char * getBasename(const char * path)
 }
 
 #if !defined(LIBOPENUI)
+// Checks whether a directory entry is listed, and strips its extension
+// unless LIST_SD_FILE_EXT is requested
+static bool getListedFileName(const char * path, FILINFO * fno, const char * extension, const uint8_t maxlen, uint8_t flags)
+{
+  const char * fnExt;
+  uint8_t fnLen, extLen;
+  char tmpExt[LEN_FILE_EXTENSION_MAX+1] = "\0";
+
+  if (fno->fattrib & AM_DIR) return false;            /* Skip subfolders */
+  if (fno->fattrib & AM_HID) return false;            /* Skip hidden files */
+  if (fno->fattrib & AM_SYS) return false;            /* Skip system files */
+
+  fnExt = getFileExtension(fno->fname, 0, 0, &fnLen, &extLen);
+  fnLen -= extLen;
+
+  // file validation checks
+  if (!fnLen || fnLen > maxlen || (                                               // wrong size
+        fnExt && extension && (                                                   // extension-based checks follow...
+          !isExtensionMatching(fnExt, extension) || (                             // wrong extension
+            !(flags & LIST_SD_FILE_EXT) &&                                        // only if we want unique file names...
+            strcasecmp(fnExt, getFileExtension(extension)) &&                     // possible duplicate file name...
+            isFilePatternAvailable(path, fno->fname, extension, true, tmpExt) &&  // find the first file from extensions list...
+            strncasecmp(fnExt, tmpExt, LEN_FILE_EXTENSION_MAX)                    // found file doesn't match, this is a duplicate
+          )
+        )
+      ))
+  {
+    return false;
+  }
+
+  if (!(flags & LIST_SD_FILE_EXT)) {
+    fno->fname[fnLen] = '\0';  // strip extension
+  }
+
+  return true;
+}
+
+// Sorted snapshot of the directory listed by sdListFiles(), so that
+// scrolling the popup does not read the directory again. It is taken each
+// time a list is opened, and lives in reusableBuffer as long as the popup:
+// FAT does not date directory changes, so the snapshot is never kept
+// longer. The names are packed from the end of the buffer, and their
+// offsets, in name order, from its start. Directories too large for the
+// buffer are read again at each step, as before.
+enum SdListCacheState {
+  SD_LIST_CACHE_NONE,
+  SD_LIST_CACHE_VALID,
+  SD_LIST_CACHE_TOO_LARGE,
+};
+
+static struct {
+  uint8_t state;
+  uint16_t count;
+  uint16_t names;  // start of the names
+} sdListCache;
+
+static uint16_t sdListCacheOffset(uint16_t index)
+{
+  const uint8_t * offsets = (const uint8_t *)reusableBuffer.modelsel.listCache;
+  return offsets[2 * index] + (offsets[2 * index + 1] << 8);
+}
+
+static const char * sdListCacheName(uint16_t index)
+{
+  return &reusableBuffer.modelsel.listCache[sdListCacheOffset(index)];
+}
+
+static bool sdListCacheAdd(const char * name)
+{
+  uint16_t len = strlen(name) + 1;
+  uint16_t count = sdListCache.count;
+  if (2 * (count + 1) + len > sdListCache.names)
+    return false;
+
+  uint16_t lo = 0, hi = count;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (strcasecmp(name, sdListCacheName(mid)) < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  char * cache = reusableBuffer.modelsel.listCache;
+  sdListCache.names -= len;
+  memcpy(&cache[sdListCache.names], name, len);
+  memmove(&cache[2 * (lo + 1)], &cache[2 * lo], 2 * (count - lo));
+  cache[2 * lo] = sdListCache.names & 0xFF;
+  cache[2 * lo + 1] = sdListCache.names >> 8;
+  sdListCache.count++;
+  return true;
+}
+
+static void sdListCacheBuild(const char * path, const char * extension, const uint8_t maxlen, uint8_t flags)
+{
+  sdListCache.state = SD_LIST_CACHE_NONE;
+  sdListCache.count = 0;
+  sdListCache.names = SD_LIST_CACHE_SIZE;
+
+  DIR dir;
+  if (f_opendir(&dir, path) != FR_OK)
+    return;
+
+  sdListCache.state = SD_LIST_CACHE_VALID;
+
+  FILINFO fno;
+  for (;;) {
+    FRESULT res = f_readdir(&dir, &fno);
+    if (res != FR_OK || fno.fname[0] == 0) break;
+    if (!getListedFileName(path, &fno, extension, maxlen, flags)) continue;
+    if (!sdListCacheAdd(fno.fname)) {
+      sdListCache.state = SD_LIST_CACHE_TOO_LARGE;
+      break;
+    }
+  }
+
+  f_closedir(&dir);
+}
+
+static uint16_t sdListCacheShow(const char * selection, const uint8_t maxlen, uint8_t flags)
+{
+  uint8_t none = (flags & LIST_NONE_SD_FILE) ? 1 : 0;
+  popupMenuItemsCount = sdListCache.count + none;
+
+  if (selection) {
+    // the list starts with the selected file
+    uint16_t lo = 0, hi = sdListCache.count;
+    while (lo < hi) {
+      uint16_t mid = (lo + hi) / 2;
+      if (strncasecmp(sdListCacheName(mid), selection, maxlen) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    popupMenuOffset = lo + none;
+  }
+
+  for (uint8_t i = 0; i < MENU_MAX_DISPLAY_LINES; i++) {
+    char * line = reusableBuffer.modelsel.menu_bss[i];
+    uint16_t index = popupMenuOffset + i;
+    memset(line, 0, MENU_LINE_LENGTH);
+    if (index < none)
+      strcpy(line, "---");
+    else if (index < popupMenuItemsCount)
+      strncpy(line, sdListCacheName(index - none), MENU_LINE_LENGTH - 1);
+    popupMenuItems[i] = line;
+  }
+
+  return popupMenuItemsCount;
+}
+
 bool sdListFiles(const char * path, const char * extension, const uint8_t maxlen, const char * selection, uint8_t flags)
 {
   static uint16_t lastpopupMenuOffset = 0;
   FILINFO fno;
   DIR dir;
-  const char * fnExt;
-  uint8_t fnLen, extLen;
-  char tmpExt[LEN_FILE_EXTENSION_MAX+1] = "\0";
 
   popupMenuOffsetType = MENU_OFFSET_EXTERNAL;
 
@@ -234,6 +382,15 @@ bool sdListFiles(const char * path, const char * extension, const uint8_t maxlen
     flags = s_last_flags;
   }
 
+  // a new list (not a scroll of the open one) takes a new snapshot
+  if (selection || popupMenuItemsCount == 0) {
+    sdListCacheBuild(path, extension, maxlen, flags);
+  }
+
+  if (sdListCache.state == SD_LIST_CACHE_VALID) {
+    return sdListCacheShow(selection, maxlen, flags);
+  }
+
   if (popupMenuOffset == 0) {
     lastpopupMenuOffset = 0;
     memset(reusableBuffer.modelsel.menu_bss, 0, sizeof(reusableBuffer.modelsel.menu_bss));
@@ -276,36 +433,13 @@ bool sdListFiles(const char * path, const char * extension, const uint8_t maxlen
     for (;;) {
       res = f_readdir(&dir, &fno);                   /* Read a directory item */
       if (res != FR_OK || fno.fname[0] == 0) break;  /* Break on error or end of dir */
-      if (fno.fattrib & AM_DIR) continue;            /* Skip subfolders */
-      if (fno.fattrib & AM_HID) continue;            /* Skip hidden files */
-      if (fno.fattrib & AM_SYS) continue;            /* Skip system files */
-
-      fnExt = getFileExtension(fno.fname, 0, 0, &fnLen, &extLen);
-      fnLen -= extLen;
-
-//      TRACE_DEBUG("listSdFiles(%s, %s, %u, %s, %u): fn='%s'; fnExt='%s'; match=%d\n",
-//           path, extension, maxlen, (selection ? selection : "nul"), flags, fno.fname, (fnExt ? fnExt : "nul"), (fnExt && isExtensionMatching(fnExt, extension)));
-      // file validation checks
-      if (!fnLen || fnLen > maxlen || (                                              // wrong size
-            fnExt && extension && (                                                  // extension-based checks follow...
-              !isExtensionMatching(fnExt, extension) || (                            // wrong extension
-                !(flags & LIST_SD_FILE_EXT) &&                                       // only if we want unique file names...
-                strcasecmp(fnExt, getFileExtension(extension)) &&                    // possible duplicate file name...
-                isFilePatternAvailable(path, fno.fname, extension, true, tmpExt) &&  // find the first file from extensions list...
-                strncasecmp(fnExt, tmpExt, LEN_FILE_EXTENSION_MAX)                   // found file doesn't match, this is a duplicate
-              )
-            )
-          ))
-      {
+
+      if (!getListedFileName(path, &fno, extension, maxlen, flags)) {
         continue;
       }
 
       popupMenuItemsCount++;
 
-      if (!(flags & LIST_SD_FILE_EXT)) {
-        fno.fname[fnLen] = '\0';  // strip extension
-      }
-
       if (popupMenuOffset == 0) {
         if (selection && strncasecmp(fno.fname, selection, maxlen) < 0) {
           lastpopupMenuOffset++;
@@ -416,6 +550,52 @@ const char * sdCopyFile(const char * srcFilename, const char * srcDir, const cha
 
   return sdCopyFile(srcPath, destPath);
 }
+
+#if FF_USE_FASTSEEK
+// With a cluster link map, f_lseek() and f_read() find the clusters of a
+// file in RAM, instead of walking its FAT chain from the start at each
+// backward seek. A map of SD_FASTSEEK_MAP_SIZE items describes up to
+// (SD_FASTSEEK_MAP_SIZE - 2) / 2 fragments: more fragmented files keep
+// seeking the usual way.
+#define SD_FASTSEEK_MAPS      2
+#define SD_FASTSEEK_MAP_SIZE  32
+
+static DWORD sdFastSeekMaps[SD_FASTSEEK_MAPS][SD_FASTSEEK_MAP_SIZE];
+static FIL * sdFastSeekOwners[SD_FASTSEEK_MAPS];
+
+bool sdEnableFastSeek(FIL * file)
+{
+  if (file->cltbl)
+    return true;
+
+  for (uint8_t i = 0; i < SD_FASTSEEK_MAPS; i++) {
+    if (!sdFastSeekOwners[i]) {
+      file->cltbl = sdFastSeekMaps[i];
+      file->cltbl[0] = SD_FASTSEEK_MAP_SIZE;
+      if (f_lseek(file, CREATE_LINKMAP) != FR_OK) {
+        TRACE("sdEnableFastSeek: %u items needed", (unsigned)file->cltbl[0]);
+        file->cltbl = nullptr;
+        return false;
+      }
+      sdFastSeekOwners[i] = file;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void sdDisableFastSeek(FIL * file)
+{
+  for (uint8_t i = 0; i < SD_FASTSEEK_MAPS; i++) {
+    if (sdFastSeekOwners[i] == file) {
+      sdFastSeekOwners[i] = nullptr;
+      file->cltbl = nullptr;
+    }
+  }
+}
+#endif
+
 #endif // defined(SDCARD)
 
 
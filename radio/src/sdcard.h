@@ -68,6 +68,7 @@ const char RADIO_SETTINGS_PATH[] = RADIO_PATH PATH_SEPARATOR RADIO_FILENAME;
 const char MODELSLIST_YAML_PATH[] = MODELS_PATH PATH_SEPARATOR "models.yml";
 const char FALLBACK_MODELSLIST_YAML_PATH[] = RADIO_PATH PATH_SEPARATOR "models.yml";
 const char RADIO_SETTINGS_YAML_PATH[] = RADIO_PATH PATH_SEPARATOR "radio.yml";
+const char MODEL_HEADERS_INDEX_PATH[] = MODELS_PATH PATH_SEPARATOR "headers.idx";
 #endif
 #define    SPLASH_FILE             "splash.png"
 #endif
@@ -180,6 +181,15 @@ unsigned int findNextFileIndex(char * filename, uint8_t size, const char * direc
 const char * sdCopyFile(const char * src, const char * dest);
 const char * sdCopyFile(const char * srcFilename, const char * srcDir, const char * destFilename, const char * destDir);
 
+#if FF_USE_FASTSEEK
+// Cluster link maps, from a small pool, for the files read at random.
+// Building a map walks the whole FAT chain, even when the file turns out
+// too fragmented: ask once per file. The map must be released before the
+// file is closed.
+extern "C" bool sdEnableFastSeek(FIL * file);
+extern "C" void sdDisableFastSeek(FIL * file);
+#endif
+
 #define LIST_NONE_SD_FILE   1
 #define LIST_SD_FILE_EXT    2
 bool sdListFiles(const char * path, const char * extension, const uint8_t maxlen, const char * selection, uint8_t flags=0);
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#ifndef _SERIAL_TX_FIFO_H_
+#define _SERIAL_TX_FIFO_H_
+
+#include "fifo.h"
+
+// TX FIFO of a serial port: the sender queues whole buffers and never
+// waits for the transmitter, the DMA (or the TX interrupt) drains it.
+// Bytes being transmitted by DMA stay in the FIFO until the transfer
+// is completed, so that they cannot be overwritten.
+template <int N>
+class SerialTxFifo: public Fifo<uint8_t, N>
+{
+  public:
+    void clear()
+    {
+      Fifo<uint8_t, N>::clear();
+      pending = 0;
+    }
+
+    // Queues the whole buffer, or nothing when there is not enough room
+    bool write(const uint8_t * data, uint32_t len)
+    {
+      if (!this->hasSpace(len)) {
+        return false;
+      }
+      this->push(data, len);
+      return true;
+    }
+
+    // Returns the next contiguous chunk to transmit, unless a chunk
+    // is still being transmitted or there is nothing to transmit
+    bool nextChunk(const uint8_t * & data, uint32_t & len)
+    {
+      if (pending || this->isEmpty()) {
+        return false;
+      }
+      uint32_t r = this->ridx;
+      uint32_t w = this->widx;
+      len = (w > r ? w : N) - r;
+      data = &this->fifo[r];
+      pending = len;
+      return true;
+    }
+
+    // The chunk returned by nextChunk() has been transmitted
+    void chunkDone()
+    {
+      this->ridx = (this->ridx + pending) & (N - 1);
+      pending = 0;
+    }
+
+    bool isBusy() const
+    {
+      return pending || !this->isEmpty();
+    }
+
+  protected:
+    volatile uint32_t pending = 0;
+};
+
+#endif // _SERIAL_TX_FIFO_H_
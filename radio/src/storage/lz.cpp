@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <string.h>
+#include "debug.h"
+
+#include "lz.h"
+
+// Tokens, tuned for model data (long zero runs and repeated structures):
+//   00nnnnnn                    n+1 literal bytes follow
+//   01nnnnnn                    n+1 zero bytes
+//   1nnnnnoo oooooooo           copy n+3 bytes from o+1 bytes back
+#define LZ_MAX_RUN       64
+#define LZ_MIN_MATCH     3
+#define LZ_MAX_MATCH     (LZ_MIN_MATCH + 31)
+#define LZ_WINDOW        1024
+#define LZ_HASH_BITS     8
+
+static inline uint8_t lzHash(const uint8_t * p)
+{
+  uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+#define CHECK_DST_SIZE(n) \
+  if (cur + (n) > dst + dstsize) { \
+    TRACE("LZ encoding size too big"); \
+    return 0; \
+  }
+
+unsigned int lzCompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len)
+{
+  // last position (+1) of each hash, 0 if none
+  uint16_t positions[1 << LZ_HASH_BITS];
+  memset(positions, 0, sizeof(positions));
+
+  uint8_t * cur = dst;
+  unsigned int literals = 0;
+  unsigned int i = 0;
+
+  while (i <= len) {
+    unsigned int zeros = 0;
+    unsigned int matchLen = 0;
+    unsigned int offset = 0;
+
+    if (i < len) {
+      while (i + zeros < len && zeros < LZ_MAX_RUN && src[i + zeros] == 0)
+        zeros++;
+
+      if (zeros < 2 && i + LZ_MIN_MATCH <= len) {
+        uint8_t hash = lzHash(&src[i]);
+        unsigned int candidate = positions[hash];
+        positions[hash] = i + 1;
+        if (candidate && i - (candidate - 1) <= LZ_WINDOW) {
+          const uint8_t * match = &src[candidate - 1];
+          while (i + matchLen < len && matchLen < LZ_MAX_MATCH && match[matchLen] == src[i + matchLen])
+            matchLen++;
+          offset = i - (candidate - 1);
+        }
+      }
+
+      if (zeros < 2 && matchLen < LZ_MIN_MATCH) {
+        i++;
+        if (++literals < LZ_MAX_RUN)
+          continue;
+      }
+    }
+
+    // flush pending literals
+    if (literals) {
+      CHECK_DST_SIZE(literals + 1);
+      *cur++ = literals - 1;
+      memcpy(cur, &src[i - literals], literals);
+      cur += literals;
+      literals = 0;
+    }
+
+    if (i == len)
+      break;
+
+    if (zeros >= 2) {
+      CHECK_DST_SIZE(1);
+      *cur++ = 0x40 | (zeros - 1);
+      i += zeros;
+    }
+    else if (matchLen >= LZ_MIN_MATCH) {
+      CHECK_DST_SIZE(2);
+      *cur++ = 0x80 | ((matchLen - LZ_MIN_MATCH) << 2) | ((offset - 1) >> 8);
+      *cur++ = (offset - 1);
+      for (unsigned int j = i + 1; j < i + matchLen && j + LZ_MIN_MATCH <= len; j++)
+        positions[lzHash(&src[j])] = j + 1;
+      i += matchLen;
+    }
+  }
+
+  return cur - dst;
+}
+
+#undef CHECK_DST_SIZE
+#define CHECK_DST_SIZE(n) \
+  if (cur + (n) > dst + dstsize) { \
+    TRACE("LZ decoding size too big"); \
+    return 0; \
+  }
+
+unsigned int lzUncompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len)
+{
+  uint8_t * cur = dst;
+  const uint8_t * end = src + len;
+
+  while (src < end) {
+    uint8_t token = *src++;
+
+    if (token & 0x80) {
+      if (src == end) {
+        TRACE("LZ decoding error");
+        return 0;
+      }
+      unsigned int count = ((token >> 2) & 0x1F) + LZ_MIN_MATCH;
+      unsigned int offset = (((token & 0x03) << 8) | *src++) + 1;
+      if (offset > (unsigned int)(cur - dst)) {
+        TRACE("LZ decoding error");
+        return 0;
+      }
+      CHECK_DST_SIZE(count);
+      // byte by byte, as the copy may overlap
+      const uint8_t * match = cur - offset;
+      while (count--)
+        *cur++ = *match++;
+    }
+    else if (token & 0x40) {
+      unsigned int count = (token & 0x3F) + 1;
+      CHECK_DST_SIZE(count);
+      memset(cur, 0, count);
+      cur += count;
+    }
+    else {
+      unsigned int count = token + 1;
+      if (count > (unsigned int)(end - src)) {
+        TRACE("LZ decoding error");
+        return 0;
+      }
+      CHECK_DST_SIZE(count);
+      memcpy(cur, src, count);
+      cur += count;
+      src += count;
+    }
+  }
+
+  return cur - dst;
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _LZ_H_
+#define _LZ_H_
+
+#include <inttypes.h>
+
+// Small window LZ77 codec: the decoder only uses its output buffer, the
+// encoder a 512 bytes hash table on the stack. Both return the number of
+// bytes written to 'dst', 0 on error or if 'dstsize' is too small.
+unsigned int lzCompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
+unsigned int lzUncompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
+
+#endif
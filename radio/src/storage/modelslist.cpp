@@ -23,6 +23,7 @@
 using std::list;
 
 #if defined(SDCARD_YAML)
+#include "sdcard_common.h"
 #include "yaml/yaml_parser.h"
 #include "yaml/yaml_modelslist.h"
 #endif
@@ -33,6 +34,7 @@ using std::list;
 #include "strhelpers.h"
 
 #include <cstring>
+#include <cstdlib>
 
 ModelsList modelslist;
 
@@ -104,14 +106,39 @@ void ModelCell::save(FIL* file)
   f_puts("    name: \"", file);
   f_puts(modelName, file);
   f_puts("\"\n", file);
+
+  if (valid_rfData) {
+    // modelId, type and sub-type for each module, in hex
+    static const char hex[] = "0123456789ABCDEF";
+    char rfData[NUM_MODULES * 6 + 1];
+    char * s = rfData;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+      const uint8_t bytes[] = {modelId[i], moduleData[i].type,
+                               moduleData[i].subType};
+      for (uint8_t b : bytes) {
+        *s++ = hex[b >> 4];
+        *s++ = hex[b & 0x0F];
+      }
+    }
+    *s = '\0';
+
+    f_puts("    rfData: \"", file);
+    f_puts(rfData, file);
+    f_puts("\"\n", file);
+  }
 #endif
 }
 
 void ModelCell::setRfData(ModelData* model)
+{
+  setRfData(&model->header, model->moduleData);
+}
+
+void ModelCell::setRfData(ModelHeader* header, ModuleData* modules)
 {
   for (uint8_t i = 0; i < NUM_MODULES; i++) {
-    modelId[i] = model->header.modelId[i];
-    setRfModuleData(i, &(model->moduleData[i]));
+    modelId[i] = header->modelId[i];
+    setRfModuleData(i, &modules[i]);
     TRACE("<%s/%i> : %X,%X,%X",
           strlen(modelName) ? modelName : modelFilename,
           i, moduleData[i].type, moduleData[i].subType, modelId[i]);
@@ -119,6 +146,35 @@ void ModelCell::setRfData(ModelData* model)
   valid_rfData = true;
 }
 
+#if defined(SDCARD_YAML)
+static int8_t hexDigit(char c)
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void ModelCell::setRfData(const char * hex, uint8_t len)
+{
+  uint8_t bytes[NUM_MODULES * 3];
+  if (len != sizeof(bytes) * 2) return;
+
+  for (uint8_t i = 0; i < sizeof(bytes); i++) {
+    int8_t hi = hexDigit(hex[2 * i]);
+    int8_t lo = hexDigit(hex[2 * i + 1]);
+    if (hi < 0 || lo < 0) return;
+    bytes[i] = (hi << 4) | lo;
+  }
+
+  for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    modelId[i] = bytes[3 * i];
+    moduleData[i].type = bytes[3 * i + 1];
+    moduleData[i].subType = bytes[3 * i + 2];
+  }
+  valid_rfData = true;
+}
+#endif
+
 void ModelCell::setRfModuleData(uint8_t moduleIdx, ModuleData* modData)
 {
   moduleData[moduleIdx].type = modData->type;
@@ -181,7 +237,21 @@ bool ModelCell::fetchRfData()
   return false;
 
 #else
-  return false;
+  // the current model is already in memory
+  if (!strncmp(modelFilename, g_eeGeneral.currModelFilename,
+               LEN_MODEL_FILENAME)) {
+    setRfData(&g_model);
+    return true;
+  }
+
+  // no cached RF data (models list written by an older version):
+  // only the header and the modules are read, the list keeps them afterwards
+  PartialModelRf partial;
+  if (readModel(modelFilename, (uint8_t *)&partial, sizeof(partial)))
+    return false;
+
+  setRfData(&partial.header, partial.moduleData);
+  return true;
 #endif
 }
 
@@ -474,8 +544,10 @@ int ModelsList::getCurrentCategoryIdx() const
 void ModelsList::setCurrentModel(ModelCell * cell)
 {
   currentModel = cell;
+#if !defined(SDCARD_YAML)
   if (!currentModel->valid_rfData)
     currentModel->fetchRfData();
+#endif
 }
 
 bool ModelsList::readNextLine(char * line, int maxlen)
@@ -543,8 +615,35 @@ void ModelsList::moveModel(ModelCell * model, ModelsCategory * previous_category
   save();
 }
 
+#if defined(SDCARD_YAML)
+void ModelsList::updateRfData()
+{
+  bool fetched = false;
+  for (auto cat : categories) {
+    for (auto cell : *cat) {
+      if (!cell->valid_rfData) {
+        fetched |= cell->fetchRfData();
+      }
+    }
+  }
+
+  if (currentModel && !strncmp(currentModel->modelFilename,
+                               g_eeGeneral.currModelFilename,
+                               LEN_MODEL_FILENAME)) {
+    currentModel->setRfData(&g_model);
+  }
+
+  // keep what has been read for the next time
+  if (fetched) save();
+}
+#endif
+
 bool ModelsList::isModelIdUnique(uint8_t moduleIdx, char* warn_buf, size_t warn_buf_len)
 {
+#if defined(SDCARD_YAML)
+  updateRfData();
+#endif
+
   ModelCell* modelCell = modelslist.getCurrentModel();
   if (!modelCell || !modelCell->valid_rfData) {
     // in doubt, pretend it's unique
@@ -610,6 +709,10 @@ bool ModelsList::isModelIdUnique(uint8_t moduleIdx, char* warn_buf, size_t warn_
 
 uint8_t ModelsList::findNextUnusedModelId(uint8_t moduleIdx)
 {
+#if defined(SDCARD_YAML)
+  updateRfData();
+#endif
+
   ModelCell * modelCell = modelslist.getCurrentModel();
   if (!modelCell || !modelCell->valid_rfData) {
     return 0;
@@ -663,3 +766,23 @@ void ModelsList::onNewModelCreated(ModelCell* cell, ModelData* model)
   model->header.modelId[INTERNAL_MODULE] = new_id;
   cell->setModelId(INTERNAL_MODULE, new_id);
 }
+
+void ModelsList::onCurrentModelSaved(const char * filename, ModelData * model)
+{
+  ModelCell * cell = currentModel;
+  if (!cell || strncmp(cell->modelFilename, filename, LEN_MODEL_FILENAME))
+    return;
+
+  uint8_t modelId[NUM_MODULES];
+  SimpleModuleData moduleData[NUM_MODULES];
+  bool valid = cell->valid_rfData;
+  memcpy(modelId, cell->modelId, sizeof(modelId));
+  memcpy(moduleData, cell->moduleData, sizeof(moduleData));
+
+  cell->setRfData(model);
+
+  if (!valid || memcmp(modelId, cell->modelId, sizeof(modelId)) ||
+      memcmp(moduleData, cell->moduleData, sizeof(moduleData))) {
+    save();
+  }
+}
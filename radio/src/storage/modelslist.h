@@ -66,6 +66,10 @@ class ModelCell
     void setModelName(char * name);
     void setModelName(char* name, uint8_t len);
     void setRfData(ModelData * model);
+    void setRfData(ModelHeader * header, ModuleData * modules);
+#if defined(SDCARD_YAML)
+    void setRfData(const char * hex, uint8_t len);
+#endif
 
     void setModelId(uint8_t moduleIdx, uint8_t id);
     void setRfModuleData(uint8_t moduleIdx, ModuleData* modData);
@@ -101,6 +105,12 @@ class ModelsList
 
   void init();
 
+#if defined(SDCARD_YAML)
+  // make sure every model has RF data, and that
+  // the current model's matches what is in memory
+  void updateRfData();
+#endif
+
 public:
 
   enum class Format {
@@ -171,6 +181,10 @@ public:
 
   void onNewModelCreated(ModelCell* cell, ModelData* model);
 
+  // refresh the current model's cell once it has been saved, from the
+  // file name and model data that were actually written
+  void onCurrentModelSaved(const char * filename, ModelData * model);
+
 protected:
   FIL file;
 
@@ -21,6 +21,8 @@
 
 #include "opentx.h"
 #include "rtc_backup.h"
+#include "crc.h"
+#include "lz.h"
 
 namespace Backup {
 #define BACKUP
@@ -39,30 +41,285 @@ Backup::RamBackupUncompressed ramBackupUncompressed __DMA;
 #if defined(SIMU)
 RamBackup _ramBackup;
 RamBackup * ramBackup = &_ramBackup;
+int32_t rambackupPowerCut = -1;
 #else
 RamBackup * ramBackup = (RamBackup *)BKPSRAM_BASE;
 #endif
 
+#define RAMBACKUP_IMAGE_SIZE   sizeof(Backup::RamBackupUncompressed)
+#define RAMBACKUP_IMAGE_PAGES  ((RAMBACKUP_IMAGE_SIZE + RAMBACKUP_PAGE_SIZE - 1) / RAMBACKUP_PAGE_SIZE)
+
+static_assert(RAMBACKUP_IMAGE_PAGES <= RAMBACKUP_PAGES, "RAM backup pages too small");
+
+static void rambackupCopy(void * dst, const void * src, unsigned int len)
+{
+#if defined(SIMU)
+  if (rambackupPowerCut >= 0) {
+    if (len > (unsigned int)rambackupPowerCut)
+      len = rambackupPowerCut;
+    rambackupPowerCut -= len;
+  }
+#endif
+  // pages are slid down within the backup when compacting it
+  memmove(dst, src, len);
+}
+
+static unsigned int getPageSize(uint8_t page)
+{
+  return min<unsigned int>(RAMBACKUP_PAGE_SIZE, RAMBACKUP_IMAGE_SIZE - page * RAMBACKUP_PAGE_SIZE);
+}
+
+static uint16_t getTableCrc(const RamBackupTable * table)
+{
+  // non-zero start value, so that a blank backup is not valid
+  return crc16(CRC_1021, (const uint8_t *)table, offsetof(RamBackupTable, crc), 0xFFFF);
+}
+
+static bool isTableValid(const RamBackupTable * table)
+{
+  return table->sequence != 0 && table->crc == getTableCrc(table);
+}
+
+// index of the last table committed, -1 if none
+static int getLastTable()
+{
+  int last = -1;
+  for (int i = 0; i < 2; i++) {
+    if (isTableValid(&ramBackup->tables[i]) &&
+        (last < 0 || ramBackup->tables[i].sequence > ramBackup->tables[last].sequence)) {
+      last = i;
+    }
+  }
+  return last;
+}
+
+static bool overlaps(const RamBackupTable * table, uint8_t count, unsigned int start, unsigned int end)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    const RamBackupPage & page = table->pages[i];
+    if (page.size && start < page.offset + page.size && page.offset < end)
+      return true;
+  }
+  return false;
+}
+
+// lowest offset where 'size' bytes do not overlap any page of the
+// last table, nor any of the first 'count' pages of the new table
+static int findFreeSpace(const RamBackupTable * last, const RamBackupTable * table, uint8_t count, unsigned int size)
+{
+  int result = -1;
+
+  for (int i = -1; i < 2 * RAMBACKUP_PAGES; i++) {
+    unsigned int start = 0;
+    if (i >= 0) {
+      const RamBackupTable * t = (i < RAMBACKUP_PAGES) ? last : table;
+      uint8_t idx = i % RAMBACKUP_PAGES;
+      if (!t || (t == table && idx >= count) || !t->pages[idx].size)
+        continue;
+      start = t->pages[idx].offset + t->pages[idx].size;
+    }
+
+    if (start + size > sizeof(ramBackup->data) || (result >= 0 && (int)start >= result))
+      continue;
+
+    if ((last && overlaps(last, RAMBACKUP_PAGES, start, start + size)) ||
+        overlaps(table, count, start, start + size))
+      continue;
+
+    result = start;
+  }
+
+  return result;
+}
+
+// Entries of the last table written or restored, each with the CRC_1189
+// of its page. Along with the CRC_1021 kept in the table, this 32 bit
+// check tells which pages changed without compressing them again.
+static struct {
+  RamBackupPage page;
+  uint16_t crc;
+} pagesCheck[RAMBACKUP_IMAGE_PAGES];
+
+static void setPagesCheck(const RamBackupTable * table, const uint16_t * crcs)
+{
+  for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+    pagesCheck[i].page = table->pages[i];
+    pagesCheck[i].crc = crcs[i];
+  }
+}
+
+static bool isPageUnchanged(const RamBackupTable * last, uint8_t page, uint16_t crc1021, uint16_t crc1189)
+{
+  return last && last->pages[page].size &&
+         !memcmp(&last->pages[page], &pagesCheck[page].page, sizeof(RamBackupPage)) &&
+         last->pages[page].crc == crc1021 && pagesCheck[page].crc == crc1189;
+}
+
 void rambackupWrite()
 {
   copyRadioData(&ramBackupUncompressed.radio, &g_eeGeneral);
   copyModelData(&ramBackupUncompressed.model, &g_model);
-  ramBackup->size = compress(ramBackup->data, sizeof(ramBackup->data),
-                             (const uint8_t *)&ramBackupUncompressed,
-                             sizeof(ramBackupUncompressed));
 
-  TRACE("RamBackupWrite sdsize=%d backupsize=%d rlcsize=%d",
-        sizeof(ModelData) + sizeof(RadioData),
-        sizeof(Backup::RamBackupUncompressed), ramBackup->size);
+  const uint8_t * image = (const uint8_t *)&ramBackupUncompressed;
+  int lastIdx = getLastTable();
+  const RamBackupTable * last = (lastIdx >= 0) ? &ramBackup->tables[lastIdx] : nullptr;
+
+  RamBackupTable table;
+  memclear(&table, sizeof(table));
+  table.sequence = last ? last->sequence + 1 : 1;
+
+  uint16_t crcs[RAMBACKUP_IMAGE_PAGES];
+  uint8_t buffer[RAMBACKUP_PAGE_SIZE + RAMBACKUP_PAGE_SIZE / 32];
+  uint8_t written = 0;
+  unsigned int total = 0;
+  bool compact = false;
+
+  for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+    const uint8_t * src = image + i * RAMBACKUP_PAGE_SIZE;
+    unsigned int len = getPageSize(i);
+    uint16_t crc = crc16(CRC_1021, src, len);
+    crcs[i] = crc16(CRC_1189, src, len);
+
+    if (isPageUnchanged(last, i, crc, crcs[i])) {
+      table.pages[i] = last->pages[i];
+      total += last->pages[i].size;
+      continue;
+    }
+
+    unsigned int size = lzCompress(buffer, sizeof(buffer), src, len);
+    if (size == 0)
+      return;
+    total += size;
+
+    if (compact)
+      continue;
+
+    int offset = findFreeSpace(last, &table, i, size);
+    if (offset < 0) {
+      // the new pages do not fit next to the last backup:
+      // write everything again, in one block
+      compact = true;
+      continue;
+    }
+
+    rambackupCopy(&ramBackup->data[offset], buffer, size);
+    table.pages[i] = {(uint16_t)offset, (uint16_t)size, crc};
+    written++;
+  }
+
+  if (compact) {
+    // the block does not overlap the last backup,
+    // which stays valid until the new table is written
+    int offset = findFreeSpace(last, &table, 0, total);
+    if (offset >= 0) {
+      // the pages written above in the way of the block are compressed again
+      for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+        RamBackupPage & page = table.pages[i];
+        if (page.size && page.offset < offset + (int)total && offset < page.offset + page.size)
+          memclear(&page, sizeof(page));
+      }
+    }
+    else {
+      // both images do not fit: the last one is dropped rather than
+      // restored while stale, and the new one written from the start
+      TRACE("RamBackupWrite no room for both backups");
+      RamBackupTable invalid;
+      memclear(&invalid, sizeof(invalid));
+      // the older table first, so that it is never restored instead
+      rambackupCopy(&ramBackup->tables[lastIdx == 0 ? 1 : 0], &invalid, sizeof(invalid));
+      rambackupCopy(&ramBackup->tables[lastIdx == 0 ? 0 : 1], &invalid, sizeof(invalid));
+      if (total > sizeof(ramBackup->data))
+        return;
+      offset = 0;
+    }
+
+    // the pages already stored are moved into the block, lowest first:
+    // when the block starts at 0, each one slides down over free space
+    // or over itself, never over a page still to be moved
+    uint32_t moved = 0;
+    while (true) {
+      int next = -1;
+      for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+        if (table.pages[i].size && !(moved & (1u << i)) &&
+            (next < 0 || table.pages[i].offset < table.pages[next].offset))
+          next = i;
+      }
+      if (next < 0)
+        break;
+      RamBackupPage & page = table.pages[next];
+      rambackupCopy(&ramBackup->data[offset], &ramBackup->data[page.offset], page.size);
+      page.offset = offset;
+      offset += page.size;
+      moved |= 1u << next;
+    }
+
+    // then the others are compressed
+    for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+      if (table.pages[i].size)
+        continue;
+      const uint8_t * src = image + i * RAMBACKUP_PAGE_SIZE;
+      unsigned int len = getPageSize(i);
+      unsigned int size = lzCompress(buffer, sizeof(buffer), src, len);
+      if (size == 0)
+        return;
+      rambackupCopy(&ramBackup->data[offset], buffer, size);
+      table.pages[i] = {(uint16_t)offset, (uint16_t)size, crc16(CRC_1021, src, len)};
+      offset += size;
+      written++;
+    }
+  }
+
+  table.crc = getTableCrc(&table);
+  rambackupCopy(&ramBackup->tables[lastIdx == 0 ? 1 : 0], &table, sizeof(table));
+  setPagesCheck(&table, crcs);
+
+  TRACE("RamBackupWrite backupsize=%d pages=%d/%d",
+        RAMBACKUP_IMAGE_SIZE, written, RAMBACKUP_IMAGE_PAGES);
+}
+
+static bool rambackupRestoreTable(const RamBackupTable * table)
+{
+  uint8_t * image = (uint8_t *)&ramBackupUncompressed;
+
+  for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+    const RamBackupPage & page = table->pages[i];
+    uint8_t * dst = image + i * RAMBACKUP_PAGE_SIZE;
+    unsigned int len = getPageSize(i);
+
+    if (page.size == 0 || page.offset + page.size > sizeof(ramBackup->data))
+      return false;
+
+    if (lzUncompress(dst, len, &ramBackup->data[page.offset], page.size) != len)
+      return false;
+
+    if (crc16(CRC_1021, dst, len) != page.crc)
+      return false;
+  }
+
+  return true;
 }
 
 bool rambackupRestore()
 {
-  if (ramBackup->size == 0)
+  int lastIdx = getLastTable();
+  if (lastIdx < 0)
     return false;
 
-  if (uncompress((uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed), ramBackup->data, ramBackup->size) != sizeof(ramBackupUncompressed))
-    return false;
+  const RamBackupTable * table = &ramBackup->tables[lastIdx];
+  if (!rambackupRestoreTable(table)) {
+    // try the previous one
+    table = &ramBackup->tables[lastIdx == 0 ? 1 : 0];
+    if (!isTableValid(table) || !rambackupRestoreTable(table))
+      return false;
+  }
+
+  // the next backup only writes the pages changed from the restored ones
+  uint16_t crcs[RAMBACKUP_IMAGE_PAGES];
+  const uint8_t * image = (const uint8_t *)&ramBackupUncompressed;
+  for (uint8_t i = 0; i < RAMBACKUP_IMAGE_PAGES; i++) {
+    crcs[i] = crc16(CRC_1189, image + i * RAMBACKUP_PAGE_SIZE, getPageSize(i));
+  }
+  setPagesCheck(table, crcs);
 
   memset(&g_eeGeneral, 0, sizeof(g_eeGeneral));
   memset(&g_model, 0, sizeof(g_model));
@@ -24,16 +24,40 @@
 
 #include "definitions.h"
 
+// The backup is split into fixed size pages, each LZ compressed on its
+// own. Only pages whose content changed are written again, into space not
+// used by the current table; the new table is then written over the older
+// one, and only becomes valid once complete (sequence number and CRC).
+#define RAMBACKUP_SIZE                 4096
+#define RAMBACKUP_PAGE_SIZE            512
+#define RAMBACKUP_PAGES                24
+
+PACK(struct RamBackupPage {
+  uint16_t offset;  // in RamBackup::data
+  uint16_t size;    // compressed size
+  uint16_t crc;     // of the uncompressed page
+});
+
+PACK(struct RamBackupTable {
+  uint32_t sequence;
+  RamBackupPage pages[RAMBACKUP_PAGES];
+  uint16_t crc;
+});
+
 PACK(struct RamBackup {
-  uint16_t size;
-  uint8_t data[4094];
+  RamBackupTable tables[2];
+  uint8_t data[RAMBACKUP_SIZE - 2 * sizeof(RamBackupTable)];
 });
 
 extern RamBackup * ramBackup;
 
+#if defined(SIMU)
+// number of bytes written to the backup before
+// simulating a power cut (-1 for no power cut)
+extern int32_t rambackupPowerCut;
+#endif
+
 void rambackupWrite();
 bool rambackupRestore();
-unsigned int compress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
-unsigned int uncompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
 
 #endif // _RTC_BACKUP_H_
@@ -26,6 +26,10 @@
 #include "conversions/conversions.h"
 #include "model_init.h"
 
+#if defined(STORAGE_TASK)
+#include "sdcard_yaml.h"
+#endif
+
 // defined either in sdcard_raw.cpp or sdcard_yaml.cpp
 void storageCreateModelsList();
 
@@ -76,8 +80,118 @@ void storageFormat()
 #endif
 }
 
+#if defined(STORAGE_TASK)
+// Copies of the settings being written by the storage task, so that the
+// menus and the mixer can go on modifying g_eeGeneral and g_model meanwhile.
+// storagePendingMsk tells which copies still have to be written: the menus
+// only fill the copies while it is 0, and the task clears it once written.
+static RadioData storageRadioCopy;
+static ModelData storageModelCopy;
+static volatile uint8_t storagePendingMsk = 0;
+static volatile uint8_t storageModelWrites = 0;
+
+// storageMutex must be locked
+static void storageWritePending()
+{
+  if (storagePendingMsk & EE_GENERAL) {
+    TRACE("eeprom write general (async)");
+    const char * error = writeGeneralSettings(&storageRadioCopy);
+    if (error) {
+      TRACE("writeGeneralSettings error=%s", error);
+    }
+  }
+
+  if (storagePendingMsk & EE_MODEL) {
+    TRACE("eeprom write model (async)");
+    const char * error = writeModel(&storageRadioCopy, &storageModelCopy);
+    if (error) {
+      TRACE("writeModel error=%s", error);
+    }
+    else {
+      storageModelWrites++;
+    }
+  }
+
+  storagePendingMsk = 0;
+}
+
+// Hands the dirty settings over to the storage task. Nothing is done while
+// the task is still busy with the previous copies: the settings then stay
+// dirty and are handed over on a later call.
+static void storageQueueWrite()
+{
+  if (storagePendingMsk)
+    return;
+
+  DEBUG_TIMER_START(debugTimerStorageCopy);
+  RTOS_LOCK_MUTEX(storageMutex);
+  uint8_t msk = storageDirtyMsk & (EE_GENERAL | EE_MODEL);
+  storageDirtyMsk &= ~msk;
+  // the model file name is part of the radio settings
+  memcpy(&storageRadioCopy, &g_eeGeneral, sizeof(RadioData));
+  if (msk & EE_MODEL) {
+    memcpy(&storageModelCopy, &g_model, sizeof(ModelData));
+  }
+  storagePendingMsk = msk;
+  RTOS_UNLOCK_MUTEX(storageMutex);
+  DEBUG_TIMER_STOP(debugTimerStorageCopy);
+
+  if (msk) {
+    RTOS_SET_FLAG(storageFlag);
+  }
+}
+
+// Called by the storage task, and by the menus before they access the model
+// files or the headers index. Only the menus hand copies over, so nothing is
+// written behind their back afterwards.
+void storageFlushPending()
+{
+  if (!storagePendingMsk)
+    return;
+
+  RTOS_LOCK_MUTEX(storageMutex);
+  DEBUG_TIMER_START(debugTimerStorageWrite);
+  // written by the other side in the meantime?
+  if (storagePendingMsk) {
+    storageWritePending();
+  }
+  DEBUG_TIMER_STOP(debugTimerStorageWrite);
+  RTOS_UNLOCK_MUTEX(storageMutex);
+}
+
+void storageCheckWritten()
+{
+  static uint8_t modelWrites = 0;
+
+  // g_model may have changed since it was copied, and the copies may already
+  // hold the next settings to be written: wait until they are written too
+  if (modelWrites == storageModelWrites || storagePendingMsk)
+    return;
+
+  RTOS_LOCK_MUTEX(storageMutex);
+  modelWrites = storageModelWrites;
+#if defined(STORAGE_MODELSLIST)
+  modelslist.onCurrentModelSaved(storageRadioCopy.currModelFilename, &storageModelCopy);
+#endif
+  RTOS_UNLOCK_MUTEX(storageMutex);
+}
+#endif
+
 void storageCheck(bool immediately)
 {
+#if defined(STORAGE_TASK)
+  if (!immediately) {
+    storageQueueWrite();
+    return;
+  }
+
+  // copies handed over before must not overwrite what is written now
+  RTOS_LOCK_MUTEX(storageMutex);
+  if (storagePendingMsk) {
+    storageWritePending();
+  }
+#endif
+
   if (storageDirtyMsk & EE_GENERAL) {
     TRACE("eeprom write general");
     storageDirtyMsk &= ~EE_GENERAL;
@@ -95,6 +209,11 @@ void storageCheck(bool immediately)
       TRACE("writeModel error=%s", error);
     }
   }
+
+#if defined(STORAGE_TASK)
+  RTOS_UNLOCK_MUTEX(storageMutex);
+  storageCheckWritten();
+#endif
 }
 
 #if defined(STORAGE_MODELSLIST)
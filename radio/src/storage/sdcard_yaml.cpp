@@ -21,6 +21,7 @@
 
 #include "opentx.h"
 #include "opentx_helpers.h"
+#include <ctype.h>
 #include "storage.h"
 #include "sdcard_common.h"
 #include "sdcard_raw.h"
@@ -92,6 +93,98 @@ void storageCreateModelsList()
 // SDCARD storage interface
 //
 
+// Files are never rewritten in place: the new content goes to
+// "<file>.tmp" first, then the old file is removed and the temporary one
+// takes its name. Removing the old file is the commit point, so that after
+// a power loss a temporary file still next to its original is dropped,
+// while one left alone is complete and only needs renaming
+// (see recoverPendingWrites()). A new file has nothing to remove, and is
+// renamed as is if the write was interrupted.
+#define TMP_EXT ".tmp"
+
+static void getTmpPath(char * tmp, const char * path)
+{
+  strcpy(tmp, path);
+  strcat(tmp, TMP_EXT);
+}
+
+static FRESULT commitFile(const char * tmp, const char * path)
+{
+  FRESULT result = f_unlink(path);
+  if (result == FR_OK || result == FR_NO_FILE) {
+    result = f_rename(tmp, path);
+  }
+  return result;
+}
+
+#if !defined(STORAGE_MODELSLIST)
+#define SWAP_EXT ".swp"
+static void recoverSwap(const char * name);
+#endif
+
+static bool hasExtension(const char * name, const char * ext)
+{
+  size_t len = strlen(name);
+  size_t extLen = strlen(ext);
+  return len > extLen && !strcasecmp(&name[len - extLen], ext);
+}
+
+// Completes or drops the writes interrupted by a power loss
+static bool recoverPendingWrites(const char * dirPath)
+{
+  DIR dir;
+  if (f_opendir(&dir, dirPath) != FR_OK)
+    return false;
+
+  bool recovered = false;
+  FILINFO fno;
+  while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+#if !defined(STORAGE_MODELSLIST)
+    if (hasExtension(fno.fname, SWAP_EXT)) {
+      recoverSwap(fno.fname);
+      recovered = true;
+      continue;
+    }
+#endif
+
+    if (!hasExtension(fno.fname, YAML_EXT TMP_EXT))
+      continue;
+
+    char tmp[256 + sizeof(TMP_EXT)];
+    getModelPath(tmp, fno.fname, dirPath);
+    char path[sizeof(tmp)];
+    strcpy(path, tmp);
+    path[strlen(path) - (sizeof(TMP_EXT) - 1)] = '\0';
+
+    FILINFO original;
+    if (f_stat(path, &original) == FR_OK) {
+      TRACE("Dropping uncommitted %s", tmp);
+      f_unlink(tmp);
+    }
+    else {
+      TRACE("Completing write of %s", path);
+      f_rename(tmp, path);
+    }
+    recovered = true;
+  }
+
+  f_closedir(&dir);
+  return recovered;
+}
+
+void recoverPendingWrites()
+{
+  recoverPendingWrites(RADIO_PATH);
+#if defined(STORAGE_MODELSLIST)
+  recoverPendingWrites(MODELS_PATH);
+#else
+  if (recoverPendingWrites(MODELS_PATH)) {
+    // renamed files keep their stamps: rebuild the headers index
+    f_unlink(MODEL_HEADERS_INDEX_PATH);
+  }
+#endif
+}
+
 const char * loadRadioSettingsYaml()
 {
     // YAML reader
@@ -105,6 +198,8 @@ const char * loadRadioSettingsYaml()
 
 const char * loadRadioSettings()
 {
+    recoverPendingWrites();
+
     FILINFO fno;
     if (f_stat(RADIO_SETTINGS_YAML_PATH, &fno) != FR_OK) {
 #if defined(STORAGE_MODELSLIST)
@@ -159,8 +254,10 @@ static bool yaml_writer(void* opaque, const char* str, size_t len)
 const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t* data)
 {
     FIL file;
+    char tmp[256 + sizeof(TMP_EXT)];
+    getTmpPath(tmp, path);
 
-    FRESULT result = f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE);
+    FRESULT result = f_open(&file, tmp, FA_CREATE_ALWAYS | FA_WRITE);
     if (result != FR_OK) {
         return SDCARD_ERROR(result);
     }
@@ -175,19 +272,34 @@ const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t*
     if (!tree.generate(yaml_writer, &ctx)) {
         if (ctx.result != FR_OK) {
             f_close(&file);
+            f_unlink(tmp);
             return SDCARD_ERROR(ctx.result);
         }
     }
 
-    f_close(&file);
+    result = f_close(&file);
+    if (result == FR_OK) {
+        result = commitFile(tmp, path);
+    }
+
+    if (result != FR_OK) {
+        f_unlink(tmp);
+        return SDCARD_ERROR(result);
+    }
+
     return NULL;
 }
 
-const char * writeGeneralSettings()
+const char * writeGeneralSettings(const RadioData * radio)
 {
     TRACE("YAML radio settings writer");
     return writeFileYaml(RADIO_SETTINGS_YAML_PATH, get_radiodata_nodes(),
-                         (uint8_t*)&g_eeGeneral);
+                         (uint8_t*)radio);
+}
+
+const char * writeGeneralSettings()
+{
+    return writeGeneralSettings(&g_eeGeneral);
 }
 
 
@@ -205,6 +317,10 @@ const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t siz
         data_nodes = get_partialmodel_nodes();
         init_model = false;
     }
+    else if (size == sizeof(PartialModelRf)) {
+        data_nodes = get_partialmodelrf_nodes();
+        init_model = false;
+    }
     else {
         TRACE("cannot find YAML data nodes for object size (size=%d)", size);
         return "YAML size error";
@@ -249,15 +365,17 @@ const char* readModel(const char* filename, uint8_t* buffer, uint32_t size, cons
     return _wrongExtentionError;
   }
 
+  // the storage task may still be writing it
+  storageFlushPending();
   return readModelYaml(filename, buffer, size, pathName);
 }
 
-const char * writeModelYaml(const char* filename)
+const char * writeModelYaml(const char* filename, const ModelData * model)
 {
     TRACE("YAML model writer");
     char path[256];
     getModelPath(path, filename);
-    return writeFileYaml(path, get_modeldata_nodes(), (uint8_t*)&g_model);
+    return writeFileYaml(path, get_modeldata_nodes(), (uint8_t*)model);
 }
 
 #if !defined(STORAGE_MODELSLIST)
@@ -271,23 +389,160 @@ void getModelNumberStr(uint8_t idx, char* model_idx)
   model_idx[sizeof(MODEL_FILENAME_PREFIX)]   = '0' + idx % 10;
   model_idx[sizeof(MODEL_FILENAME_PREFIX)+1] = '\0';
 }
+
+static void getModelHeadersIndexHeader(ModelHeadersIndexHeader * header)
+{
+  memcpy(header->magic, "MHI", sizeof(header->magic));
+  header->version = MODEL_HEADERS_INDEX_VERSION;
+  header->entries = MAX_MODELS;
+  header->entrySize = sizeof(ModelHeadersIndexEntry);
+  header->layout = MODEL_HEADER_LAYOUT_HASH;
+}
+
+static bool openModelHeadersIndex(FIL * file, BYTE mode)
+{
+  if (f_open(file, MODEL_HEADERS_INDEX_PATH, mode) != FR_OK)
+    return false;
+
+  ModelHeadersIndexHeader expected, header;
+  getModelHeadersIndexHeader(&expected);
+
+  UINT read;
+  if (f_read(file, &header, sizeof(header), &read) != FR_OK ||
+      read != sizeof(header) || memcmp(&header, &expected, sizeof(header))) {
+    f_close(file);
+    return false;
+  }
+
+  return true;
+}
+
+static void setModelFileStamp(ModelFileStamp * stamp, const FILINFO * fno)
+{
+  stamp->size = fno->fsize;
+  stamp->date = fno->fdate;
+  stamp->time = fno->ftime;
+}
+
+// Reads the stamps of all model files with a single pass over the directory
+static void scanModelFiles(ModelFileStamp * stamps)
+{
+  memclear(stamps, MAX_MODELS * sizeof(ModelFileStamp));
+
+  DIR dir;
+  if (f_opendir(&dir, MODELS_PATH) != FR_OK)
+    return;
+
+  FILINFO fno;
+  while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+    // model[00-99].yml
+    const char * name = fno.fname;
+    const uint8_t prefixLen = sizeof(MODEL_FILENAME_PREFIX) - 1;
+    if (strncasecmp(name, MODEL_FILENAME_PREFIX, prefixLen) ||
+        !isdigit((unsigned char)name[prefixLen]) ||
+        !isdigit((unsigned char)name[prefixLen + 1]) ||
+        strcasecmp(&name[prefixLen + 2], YAML_EXT)) {
+      continue;
+    }
+    uint8_t idx = (name[prefixLen] - '0') * 10 + name[prefixLen + 1] - '0';
+    if (idx < MAX_MODELS) {
+      setModelFileStamp(&stamps[idx], &fno);
+    }
+  }
+
+  f_closedir(&dir);
+}
+
+static void writeModelHeadersIndex(const ModelFileStamp * stamps)
+{
+  FIL file;
+  if (f_open(&file, MODEL_HEADERS_INDEX_PATH, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    return;
+
+  ModelHeadersIndexHeader header;
+  getModelHeadersIndexHeader(&header);
+
+  UINT written;
+  FRESULT result = f_write(&file, &header, sizeof(header), &written);
+
+  for (uint8_t i = 0; i < MAX_MODELS && result == FR_OK; i++) {
+    ModelHeadersIndexEntry entry;
+    entry.stamp = stamps[i];
+    memcpy(&entry.header, &modelHeaders[i], sizeof(ModelHeader));
+    result = f_write(&file, &entry, sizeof(entry), &written);
+  }
+
+  f_close(&file);
+
+  if (result != FR_OK) {
+    f_unlink(MODEL_HEADERS_INDEX_PATH);
+  }
+}
+
+// Updates the index entry of a model file just written with 'header',
+// or invalidates it when 'header' is null
+static void updateModelHeadersIndex(uint8_t idx, const ModelHeader * header)
+{
+  FIL file;
+  if (!openModelHeadersIndex(&file, FA_OPEN_EXISTING | FA_READ | FA_WRITE))
+    return;
+
+  ModelHeadersIndexEntry entry;
+  memset(&entry.stamp, 0xFF, sizeof(entry.stamp));
+  memclear(&entry.header, sizeof(entry.header));
+
+  if (header) {
+    char model_idx[MODELIDX_STRLEN];
+    getModelNumberStr(idx, model_idx);
+    GET_FILENAME(fname, MODELS_PATH, model_idx, YAML_EXT);
+
+    FILINFO fno;
+    if (f_stat(fname, &fno) == FR_OK) {
+      setModelFileStamp(&entry.stamp, &fno);
+      memcpy(&entry.header, header, sizeof(ModelHeader));
+    }
+  }
+
+  UINT written;
+  if (f_lseek(&file, sizeof(ModelHeadersIndexHeader) + idx * sizeof(entry)) != FR_OK ||
+      f_write(&file, &entry, sizeof(entry), &written) != FR_OK) {
+    f_close(&file);
+    f_unlink(MODEL_HEADERS_INDEX_PATH);
+    return;
+  }
+
+  f_close(&file);
+}
 #endif
 
-const char * writeModel()
+const char * writeModel(const RadioData * radio, const ModelData * model)
 {
 #if defined(STORAGE_MODELSLIST)
-  return writeModelYaml(g_eeGeneral.currModelFilename);
+  return writeModelYaml(radio->currModelFilename, model);
 #else
   char fname[MODELIDX_STRLEN + sizeof(YAML_EXT)];
-  getModelNumberStr(g_eeGeneral.currModel, fname);
+  getModelNumberStr(radio->currModel, fname);
   strcat(fname, YAML_EXT);
-  return writeModelYaml(fname);
+  const char * error = writeModelYaml(fname, model);
+  updateModelHeadersIndex(radio->currModel, error ? nullptr : &model->header);
+  return error;
 #endif
 }
 
+const char * writeModel()
+{
+  const char * error = writeModel(&g_eeGeneral, &g_model);
+#if defined(STORAGE_MODELSLIST)
+  if (!error) modelslist.onCurrentModelSaved(g_eeGeneral.currModelFilename, &g_model);
+#endif
+  return error;
+}
+
 #if !defined(STORAGE_MODELSLIST)
 void loadModelHeader(uint8_t id, ModelHeader* header)
 {
+  storageFlushPending();
+
   PartialModel partial;
   memclear(&partial, sizeof(PartialModel));
 
@@ -300,6 +555,49 @@ void loadModelHeader(uint8_t id, ModelHeader* header)
   }
 }
 
+void loadModelHeaders()
+{
+  storageFlushPending();
+
+  ModelFileStamp stamps[MAX_MODELS];
+  scanModelFiles(stamps);
+
+  // headers still matching their file are taken from the index
+  uint8_t stale[(MAX_MODELS + 7) / 8];
+  memset(stale, 0xFF, sizeof(stale));
+
+  FIL file;
+  if (openModelHeadersIndex(&file, FA_OPEN_EXISTING | FA_READ)) {
+    for (uint8_t i = 0; i < MAX_MODELS; i++) {
+      ModelHeadersIndexEntry entry;
+      UINT read;
+      if (f_read(&file, &entry, sizeof(entry), &read) != FR_OK || read != sizeof(entry))
+        break;
+      if (!memcmp(&entry.stamp, &stamps[i], sizeof(ModelFileStamp))) {
+        memcpy(&modelHeaders[i], &entry.header, sizeof(ModelHeader));
+        stale[i >> 3] &= ~(1 << (i & 7));
+      }
+    }
+    f_close(&file);
+  }
+
+  bool changed = false;
+  for (uint8_t i = 0; i < MAX_MODELS; i++) {
+    if (stale[i >> 3] & (1 << (i & 7))) {
+      memclear(&modelHeaders[i], sizeof(ModelHeader));
+      if (stamps[i].size) {
+        loadModelHeader(i, &modelHeaders[i]);
+      }
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    TRACE("Model headers index rebuilt");
+    writeModelHeadersIndex(stamps);
+  }
+}
+
 const char * loadModel(uint8_t idx, bool alarms)
 {
   char fname[MODELIDX_STRLEN + sizeof(YAML_EXT)];
@@ -329,6 +627,8 @@ bool copyModel(uint8_t dst, uint8_t src)
   GET_FILENAME(fname_src, MODELS_PATH, model_idx_src, YAML_EXT);
   GET_FILENAME(fname_dst, MODELS_PATH, model_idx_dst, YAML_EXT);
 
+  storageFlushPending();
+  updateModelHeadersIndex(dst, nullptr);
   return sdCopyFile(fname_src, fname_dst);
 }
 
@@ -340,46 +640,89 @@ static void swapModelHeaders(uint8_t id1, uint8_t id2)
   memcpy(&modelHeaders[id2], tmp, sizeof(ModelHeader));
 }
 
+// The content of model 1 is parked as "model<1>-<2>.swp" while model 2
+// takes its place, so that a swap interrupted by a power loss can be
+// completed at boot from the file name alone
+static void getSwapFilename(char * name, uint8_t id1, uint8_t id2)
+{
+  getModelNumberStr(id1, name);
+  size_t len = strlen(name);
+  name[len++] = '-';
+  name[len++] = '0' + id2 / 10;
+  name[len++] = '0' + id2 % 10;
+  strcpy(&name[len], SWAP_EXT);
+}
+
+static void recoverSwap(const char * name)
+{
+  // model[00-99]-[00-99].swp
+  const uint8_t prefixLen = sizeof(MODEL_FILENAME_PREFIX) - 1;
+  if (strlen(name) != prefixLen + 5 + sizeof(SWAP_EXT) - 1)
+    return;
+  const char * ids = &name[prefixLen];
+  if (!isdigit((unsigned char)ids[0]) || !isdigit((unsigned char)ids[1]) ||
+      ids[2] != '-' || !isdigit((unsigned char)ids[3]) ||
+      !isdigit((unsigned char)ids[4])) {
+    return;
+  }
+
+  char model_idx_1[MODELIDX_STRLEN];
+  char model_idx_2[MODELIDX_STRLEN];
+  getModelNumberStr((ids[0] - '0') * 10 + ids[1] - '0', model_idx_1);
+  getModelNumberStr((ids[3] - '0') * 10 + ids[4] - '0', model_idx_2);
+
+  GET_FILENAME(fname1, MODELS_PATH, model_idx_1, YAML_EXT);
+  GET_FILENAME(fname2, MODELS_PATH, model_idx_2, YAML_EXT);
+  char fnameSwap[256];
+  getModelPath(fnameSwap, name, MODELS_PATH);
+
+  TRACE("Completing swap %s", name);
+  FILINFO fno;
+  if (f_stat(fname1, &fno) != FR_OK) {
+    f_rename(fname2, fname1);
+  }
+  f_rename(fnameSwap, fname2);
+}
+
 void swapModels(uint8_t id1, uint8_t id2)
 {
+  storageFlushPending();
+  updateModelHeadersIndex(id1, nullptr);
+  updateModelHeadersIndex(id2, nullptr);
+
   char model_idx_1[MODELIDX_STRLEN];
   char model_idx_2[MODELIDX_STRLEN];
+  char swap_name[MODELIDX_STRLEN + 3 + sizeof(SWAP_EXT)];
   getModelNumberStr(id1, model_idx_1);
   getModelNumberStr(id2, model_idx_2);
+  getSwapFilename(swap_name, id1, id2);
   
   GET_FILENAME(fname1, MODELS_PATH, model_idx_1, YAML_EXT);
-  GET_FILENAME(fname1_tmp, MODELS_PATH, model_idx_1, ".tmp");
   GET_FILENAME(fname2, MODELS_PATH, model_idx_2, YAML_EXT);
+  GET_FILENAME(fnameSwap, MODELS_PATH, swap_name, "");
 
-  FILINFO fno;
-  if (f_stat(fname2,&fno) != FR_OK) {
-    if (f_stat(fname1,&fno) == FR_OK) {
-      if (f_rename(fname1, fname2) == FR_OK)
-        swapModelHeaders(id1,id2);
-    }
+  // the missing files are reported by f_rename(), no need to check first
+  FRESULT result = f_rename(fname1, fnameSwap);
+  if (result == FR_NO_FILE) {
+    if (f_rename(fname2, fname1) == FR_OK)
+      swapModelHeaders(id1,id2);
     return;
   }
 
-  if (f_stat(fname1,&fno) != FR_OK) {
-    f_rename(fname2, fname1);
-    return;
-  }
-
-  // just in case...
-  f_unlink(fname1_tmp);
-
-  if (f_rename(fname1, fname1_tmp) != FR_OK) {
+  if (result != FR_OK) {
     TRACE("Error renaming 1");
     return;
   }
 
-  if (f_rename(fname2, fname1) != FR_OK) {
+  result = f_rename(fname2, fname1);
+  if (result != FR_OK && result != FR_NO_FILE) {
     TRACE("Error renaming 2");
+    f_rename(fnameSwap, fname1);
     return;
   }
 
-  if (f_rename(fname1_tmp, fname2) != FR_OK) {
-    TRACE("Error renaming 1 tmp");
+  if (f_rename(fnameSwap, fname2) != FR_OK) {
+    TRACE("Error renaming swap");
     return;
   }
 
@@ -392,11 +735,13 @@ int8_t deleteModel(uint8_t idx)
   getModelNumberStr(idx, model_idx);
   GET_FILENAME(fname, MODELS_PATH, model_idx, YAML_EXT);
 
+  storageFlushPending();
   if (f_unlink(fname) != FR_OK) {
     return -1;
   }
 
   modelHeaders[idx].name[0] = '\0';
+  updateModelHeadersIndex(idx, nullptr);
   return 0;
 }
 
@@ -448,6 +793,7 @@ const char * backupModel(uint8_t idx)
   getModelNumberStr(idx, model_idx);
   strcat(model_idx, STR_YAML_EXT);
   
+  storageFlushPending();
   return sdCopyFile(model_idx, STR_MODELS_PATH, buf, STR_BACKUP_PATH);
 }
 
@@ -461,6 +807,8 @@ const char * restoreModel(uint8_t idx, char *model_name)
   getModelNumberStr(idx, model_idx);
   strcat(model_idx, STR_YAML_EXT);
 
+  storageFlushPending();
+  updateModelHeadersIndex(idx, nullptr);
   const char* error = sdCopyFile(buf, STR_BACKUP_PATH, model_idx, STR_MODELS_PATH);
   if (!error) {
     loadModelHeader(idx, &modelHeaders[idx]);
@@ -474,5 +822,6 @@ const char * restoreModel(uint8_t idx, char *model_name)
 bool storageReadRadioSettings(bool checks)
 {
   if (!sdMounted()) sdInit();
+  recoverPendingWrites();
   return loadRadioSettingsYaml() == nullptr;
 }
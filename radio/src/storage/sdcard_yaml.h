@@ -23,6 +23,51 @@
 constexpr uint8_t MODELIDX_STRLEN = sizeof(MODEL_FILENAME_PREFIX "00");
 
 const char * loadRadioSettingsYaml();
-const char * writeModelYaml(const char* filename);
+const char * writeModelYaml(const char* filename, const ModelData * model = &g_model);
+// write the settings from copies instead of g_eeGeneral / g_model
+const char * writeGeneralSettings(const RadioData * radio);
+const char * writeModel(const RadioData * radio, const ModelData * model);
 const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName = STR_MODELS_PATH);
 void getModelNumberStr(uint8_t idx, char* model_idx);
+void recoverPendingWrites();
+
+#if !defined(STORAGE_MODELSLIST)
+// Index of the model headers, so that booting does not parse every
+// model file. It holds one entry per model slot: the size and date of the
+// model file the header was read from, followed by the header itself.
+// Entries not matching their file any more are read again from the file.
+#define MODEL_HEADERS_INDEX_VERSION  2
+
+PACK(struct ModelFileStamp {
+  uint32_t size;  // 0 if the file does not exist
+  uint16_t date;
+  uint16_t time;
+});
+
+PACK(struct ModelHeadersIndexEntry {
+  ModelFileStamp stamp;
+  ModelHeader header;
+});
+
+PACK(struct ModelHeadersIndexHeader {
+  char magic[3];
+  uint8_t version;
+  uint8_t entries;
+  uint16_t entrySize;
+  uint32_t layout;
+});
+
+// FNV-1a over the offsets and sizes of the ModelHeader fields: an index
+// written with another header layout of the same size is not used
+constexpr uint32_t modelHeaderLayoutHash(uint32_t hash, uint32_t value)
+{
+  return (hash ^ value) * 16777619u;
+}
+
+constexpr uint32_t MODEL_HEADER_LAYOUT_HASH =
+  modelHeaderLayoutHash(modelHeaderLayoutHash(modelHeaderLayoutHash(
+  modelHeaderLayoutHash(modelHeaderLayoutHash(2166136261u,
+    offsetof(ModelHeader, name)), sizeof(ModelHeader::name)),
+    offsetof(ModelHeader, modelId)), sizeof(ModelHeader::modelId)),
+    sizeof(ModelHeader));
+#endif
@@ -51,6 +51,16 @@ void storageFormat();
 void storageReadAll();
 void storageCheck(bool immediately);
 
+#if defined(STORAGE_TASK)
+// storageCheck(false) only copies the dirty settings, they are written by
+// the storage task calling storageFlushPending(). The menus get notified of
+// the completion by storageCheckWritten().
+extern "C" void storageFlushPending();
+void storageCheckWritten();
+#else
+#define storageFlushPending()
+#endif
+
 //
 // Generic storage functions (implemented in storage_common.cpp)
 //
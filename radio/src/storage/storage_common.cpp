@@ -65,7 +65,9 @@ void preModelLoad()
 #endif
 #if defined(HARDWARE_EXTERNAL_MODULE)
   stopPulsesExternalModule();
-  RTOS_WAIT_MS(200);
+  // the module is started again once the new model
+  // is loaded and it has been off long enough
+  requestModuleRestart(EXTERNAL_MODULE, MODULE_RELOAD_OFF_TIME);
 #endif
 
   stopTrainer();
@@ -277,12 +279,15 @@ uint8_t findEmptyModel(uint8_t id, bool down)
 
 ModelHeader modelHeaders[MAX_MODELS];
 
+#if !defined(SDCARD_YAML) || defined(STORAGE_MODELSLIST)
+// YAML storage keeps an index of the headers (see sdcard_yaml.cpp)
 void loadModelHeaders()
 {
   for (uint32_t i=0; i<MAX_MODELS; i++) {
     loadModelHeader(i, &modelHeaders[i]);
   }
 }
+#endif
 
 uint8_t findNextUnusedModelId(uint8_t index, uint8_t module)
 {
@@ -65,5 +65,5 @@
 #error "Board not supported by YAML storage"
 #endif
 
-static_assert(MAX_STR > MAX_RADIODATA_MODELDATA_PARTIALMODEL_STR_LEN,
-              "MAX_STR > MAX_RADIODATA_MODELDATA_PARTIALMODEL_STR_LEN");
+static_assert(MAX_STR > MAX_RADIODATA_MODELDATA_PARTIALMODEL_PARTIALMODELRF_STR_LEN,
+              "MAX_STR > MAX_RADIODATA_MODELDATA_PARTIALMODEL_PARTIALMODELRF_STR_LEN");
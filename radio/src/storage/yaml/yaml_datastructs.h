@@ -27,5 +27,6 @@ struct YamlNode;
 const YamlNode* get_radiodata_nodes();
 const YamlNode* get_modeldata_nodes();
 const YamlNode* get_partialmodel_nodes();
+const YamlNode* get_partialmodelrf_nodes();
 
 #endif
@@ -872,8 +872,13 @@ static const struct YamlNode struct_PartialModel[] = {
   YAML_ARRAY("timers", 88, 3, struct_TimerData, NULL),
   YAML_END
 };
+static const struct YamlNode struct_PartialModelRf[] = {
+  YAML_STRUCT("header", 96, struct_ModelHeader, NULL),
+  YAML_ARRAY("moduleData", 232, 2, struct_ModuleData, NULL),
+  YAML_END
+};
 
-#define MAX_RADIODATA_MODELDATA_PARTIALMODEL_STR_LEN 29
+#define MAX_RADIODATA_MODELDATA_PARTIALMODEL_PARTIALMODELRF_STR_LEN 29
 
 static const struct YamlNode __RadioData_root_node = YAML_ROOT( struct_RadioData );
 
@@ -893,4 +898,10 @@ const YamlNode* get_partialmodel_nodes()
 {
    return &__PartialModel_root_node;
 }
+static const struct YamlNode __PartialModelRf_root_node = YAML_ROOT( struct_PartialModelRf );
+
+const YamlNode* get_partialmodelrf_nodes()
+{
+   return &__PartialModelRf_root_node;
+}
 
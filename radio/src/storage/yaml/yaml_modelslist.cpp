@@ -134,6 +134,13 @@ static void set_attr(void* ctx, char* buf, uint8_t len)
             model->setModelName(buf, len);
           }
         }
+      } else if (!strcmp(mi->current_attr, "rfData")) {
+        if (!cats.empty()) {
+          auto cat = cats.back();
+          if (!cat->empty()) {
+            cat->back()->setRfData(buf, len);
+          }
+        }
       }
       break;
   }
@@ -144,7 +151,8 @@ static const YamlParserCalls modelslistCalls = {
     to_child,
     to_next_elmt,
     find_node,
-    set_attr
+    set_attr,
+    nullptr
 };
 
 const YamlParserCalls* get_modelslist_parser_calls()
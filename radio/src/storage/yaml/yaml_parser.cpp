@@ -41,6 +41,7 @@ void YamlParser::init(const YamlParserCalls* parser_calls, void* parser_ctx)
     ctx   = parser_ctx;
     reset();
     eof = false;
+    skip_node = false;
 }
 
 void YamlParser::reset()
@@ -76,6 +77,18 @@ uint8_t YamlParser::getLastIndent()
     return indents[level];
 }
 
+bool YamlParser::skipNode()
+{
+    if (calls->is_done && calls->is_done(ctx)) {
+        TRACE_YAML("STOP (nothing left to find)!\n");
+        return false;
+    }
+
+    skip_node = true;
+    skip_indent = indent;
+    return true;
+}
+
 YamlParser::YamlResult
 YamlParser::parse(const char* buffer, unsigned int size)
 {
@@ -110,6 +123,15 @@ YamlParser::parse(const char* buffer, unsigned int size)
                 break;
             }
 
+            if (skip_node) {
+                if (indent > skip_indent) {
+                    // child of an unknown node: nothing to look for
+                    state = ps_Skip;
+                    continue;
+                }
+                skip_node = false;
+            }
+
             if (*c == '\r' || *c == '\n') {
                 saved_state = state;
                 state = ps_CRLF;
@@ -180,6 +202,8 @@ YamlParser::parse(const char* buffer, unsigned int size)
                     if (!node_found) {
                         TRACE_YAML("YAML_PARSER: Could not find node '%.*s' (2)\n",
                               scratch_len, scratch_buf);
+                        if (!skipNode())
+                            return DONE_PARSING;
                     }
                 }
                 saved_state = state;
@@ -193,6 +217,13 @@ YamlParser::parse(const char* buffer, unsigned int size)
                     if (!node_found) {
                         TRACE_YAML("YAML_PARSER: Could not find node '%.*s' (3)\n",
                               scratch_len, scratch_buf);
+                        if (!skipNode())
+                            return DONE_PARSING;
+
+                        // skip the value up to the end of line
+                        saved_state = ps_Sep;
+                        state = ps_CRLF;
+                        break;
                     }
                 }
                 state = ps_Sep;
@@ -307,6 +338,14 @@ YamlParser::parse(const char* buffer, unsigned int size)
                 reset();
             }
             break;
+
+        case ps_Skip:
+            if (*c == '\n') {
+                // keep indents and element state untouched
+                indent = 0;
+                state = ps_Indent;
+            }
+            break;
         }
 
         c++;
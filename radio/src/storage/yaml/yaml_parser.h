@@ -34,6 +34,9 @@ struct YamlParserCalls
     bool (*to_next_elmt) (void* ctx);
     bool (*find_node)    (void* ctx, char* buf, uint8_t len);
     void (*set_attr)     (void* ctx, char* buf, uint8_t len);
+
+    // optional: return true when no further node can match
+    bool (*is_done)      (void* ctx);
 };
 
 class YamlParser
@@ -51,7 +54,8 @@ class YamlParser
         ps_ValEsc1,
         ps_ValEsc2,
         ps_ValEsc3,
-        ps_CRLF
+        ps_CRLF,
+        ps_Skip
     };
 
     // last indents for each level
@@ -75,6 +79,11 @@ class YamlParser
     bool node_found;
     bool eof;
 
+    // lines indented deeper than 'skip_indent' belong
+    // to an unknown node and are skipped without parsing
+    bool    skip_node;
+    uint8_t skip_indent;
+
     // tree iterator state
     const YamlParserCalls* calls;
     void*                  ctx;
@@ -86,6 +95,10 @@ class YamlParser
     bool    toParent();
     uint8_t getLastIndent();
 
+    // Called when an attribute could not be found:
+    // return false if parsing can stop right here
+    bool skipNode();
+
 public:
 
     enum YamlResult {
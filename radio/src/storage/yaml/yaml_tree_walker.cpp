@@ -199,7 +199,9 @@ static bool yaml_output_attr(void* user, uint8_t* ptr, uint32_t bit_ofs,
 YamlTreeWalker::YamlTreeWalker()
     : stack_level(NODE_STACK_DEPTH),
       virt_level(0),
-      anon_union(0)
+      anon_union(0),
+      last_attr_found(false),
+      done(false)
 {
     memset(stack,0,sizeof(stack));
 }
@@ -209,6 +211,8 @@ void YamlTreeWalker::reset(const YamlNode* node, uint8_t* data)
     this->data = data;
     stack_level = NODE_STACK_DEPTH;
     virt_level  = 0;
+    last_attr_found = false;
+    done = false;
 
     push();
     setNode(node);
@@ -269,6 +273,8 @@ bool YamlTreeWalker::findNode(const char* tag, uint8_t tag_len)
 
         if ((tag_len == attr->tag_len)
             && !strncmp(tag, attr->tag, tag_len)) {
+            if (!hasParent() && (attr + 1)->type == YDT_NONE)
+                last_attr_found = true;
             return true; // attribute found!
         }
 
@@ -276,6 +282,9 @@ bool YamlTreeWalker::findNode(const char* tag, uint8_t tag_len)
         attr = getAttr();
     }
 
+    if (!hasParent() && last_attr_found)
+        done = true;
+
     return false;
 }
 
@@ -683,12 +692,18 @@ static void set_attr(void* ctx, char* buf, uint8_t len)
     ((YamlTreeWalker*)ctx)->setAttrValue(buf,len);
 }
 
+static bool is_done(void* ctx)
+{
+    return ((YamlTreeWalker*)ctx)->isDone();
+}
+
 const YamlParserCalls YamlTreeWalkerCalls = {
     to_parent,
     to_child,
     to_next_elmt,
     find_node,
-    set_attr
+    set_attr,
+    is_done
 };
 
 const YamlParserCalls* YamlTreeWalker::get_parser_calls()
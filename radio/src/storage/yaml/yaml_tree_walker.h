@@ -49,6 +49,12 @@ class YamlTreeWalker
     uint8_t virt_level;
     uint8_t anon_union;
 
+    // files are written in schema order: once the last root
+    // attribute has been found, any unknown root attribute
+    // following it means there is nothing left to read
+    bool last_attr_found;
+    bool done;
+
     uint8_t* data;
 
     uint32_t getAttrOfs() { return stack[stack_level].bit_ofs; }
@@ -145,6 +151,9 @@ public:
     // return true if a match has been found.
     bool findNode(const char* tag, uint8_t tag_len);
 
+    // true if no further node can be matched
+    bool isDone() { return done; }
+
     // Get the current bit offset
     unsigned int getBitOffset();
 
@@ -73,16 +73,22 @@ static void aux_serial_putc(void* ctx, uint8_t c)
 
 static void aux_serial_send_buffer(void* ctx, const uint8_t* data, uint8_t size)
 {
-  while(size > 0) {
-    aux_serial_putc(ctx, *data++);
+  auto st = (const SerialState*)ctx;
+  if (size == 0) return;
+
+  // Queue as much as possible, and start
+  // the IRQ based transfer only once
+  while (size > 0 && !st->txFifo->isFull()) {
+    st->txFifo->push(*data++);
     size--;
   }
+  stm32_usart_send_buffer(st->usart, nullptr, 0);
 }
 
 static void aux_wait_tx_completed(void* ctx)
 {
-  // TODO
-  (void)ctx;
+  auto st = (const SerialState*)ctx;
+  while (stm32_usart_tx_busy(st->usart));
 }
 
 static int aux_get_byte(void* ctx, uint8_t* data)
@@ -92,6 +98,13 @@ static int aux_get_byte(void* ctx, uint8_t* data)
   return st->rxFifo->pop(*data);
 }
 
+static int aux_get_buffer(void* ctx, uint8_t* data, uint32_t len)
+{
+  auto st = (const SerialState*)ctx;
+  if (!st->rxFifo) return 0;
+  return st->rxFifo->pop(data, len);
+}
+
 void aux_serial_deinit(void* ctx)
 {
   auto st = (const SerialState*)ctx;
@@ -124,6 +137,7 @@ static const stm32_usart_t auxUSART = {
   .rxDMA = AUX_SERIAL_DMA_RX,
   .rxDMA_Stream = AUX_SERIAL_DMA_Stream_RX_LL,
   .rxDMA_Channel = AUX_SERIAL_DMA_Channel_RX,
+  .txFifo = nullptr,
 };
 
 static const SerialState auxSerialState = {
@@ -175,6 +189,7 @@ const etx_serial_driver_t AuxSerialDriver = {
   .sendBuffer = aux_serial_send_buffer,
   .waitForTxCompleted = aux_wait_tx_completed,
   .getByte = aux_get_byte,
+  .getBuffer = aux_get_buffer,
   .getBaudrate = nullptr,
   .setReceiveCb = aux1SetRxCb,
   .setBaudrateCb = nullptr,
@@ -214,6 +229,7 @@ static const stm32_usart_t aux2USART = {
   .rxDMA = AUX2_SERIAL_DMA_RX,
   .rxDMA_Stream = AUX2_SERIAL_DMA_Stream_RX_LL,
   .rxDMA_Channel = AUX2_SERIAL_DMA_Channel_RX,
+  .txFifo = nullptr,
 };
 
 static const SerialState aux2SerialState = {
@@ -269,6 +285,7 @@ const etx_serial_driver_t Aux2SerialDriver = {
   .sendBuffer = aux_serial_send_buffer,
   .waitForTxCompleted = aux_wait_tx_completed,
   .getByte = aux_get_byte,
+  .getBuffer = aux_get_buffer,
   .getBaudrate = nullptr,
   .setReceiveCb = aux2SetRxCb,
   .setBaudrateCb = nullptr,
@@ -92,11 +92,11 @@ void extmodulePpmStart(uint16_t ppm_delay, bool polarity)
   config_ppm_output(ppm_delay, polarity);
 }
 
-void extmoduleSendNextFramePpm(void* pulses, uint16_t length,
+bool extmoduleSendNextFramePpm(void* pulses, uint16_t length,
                                uint16_t ppm_delay, bool polarity)
 {
   if (!stm32_pulse_if_not_running_disable(&extmoduleTimer))
-    return;
+    return false;
 
   // Set polarity
   stm32_pulse_set_polarity(&extmoduleTimer, !polarity);
@@ -104,6 +104,7 @@ void extmoduleSendNextFramePpm(void* pulses, uint16_t length,
   // Start DMA request and re-enable timer
   stm32_pulse_start_dma_req(&extmoduleTimer, pulses, length,
                             LL_TIM_OCMODE_PWM1, ppm_delay * 2);
+  return true;
 }
 
 #if defined(PXX1)
@@ -114,13 +115,14 @@ void extmodulePxx1PulsesStart()
   stm32_pulse_init(&extmoduleTimer);
 }
 
-void extmoduleSendNextFramePxx1(const void* pulses, uint16_t length)
+bool extmoduleSendNextFramePxx1(const void* pulses, uint16_t length)
 {
-  if (!stm32_pulse_if_not_running_disable(&extmoduleTimer)) return;
+  if (!stm32_pulse_if_not_running_disable(&extmoduleTimer)) return false;
 
   // Start DMA request and re-enable timer
   stm32_pulse_start_dma_req(&extmoduleTimer, pulses, length, LL_TIM_OCMODE_PWM1,
                             9 * 2);
+  return true;
 }
 #endif
 
@@ -132,16 +134,17 @@ void extmoduleSerialStart()
   stm32_pulse_config_output(&extmoduleTimer, true, LL_TIM_OCMODE_TOGGLE, 0);
 }
 
-void extmoduleSendNextFrameSoftSerial(const void* pulses, uint16_t length, bool polarity)
+bool extmoduleSendNextFrameSoftSerial(const void* pulses, uint16_t length, bool polarity)
 {
   if (!stm32_pulse_if_not_running_disable(&extmoduleTimer))
-    return;
+    return false;
 
   // Set polarity
   stm32_pulse_set_polarity(&extmoduleTimer, polarity);
   
   // Start DMA request and re-enable timer
   stm32_pulse_start_dma_req(&extmoduleTimer, pulses, length, LL_TIM_OCMODE_TOGGLE, 0);
+  return true;
 }
 
 void extmoduleInitTxPin()
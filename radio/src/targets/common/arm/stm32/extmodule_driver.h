@@ -28,16 +28,18 @@ void extmodulePpmStart(uint16_t ppm_delay, bool polarity);
 
 #if defined(PXX1)
 void extmodulePxx1PulsesStart();
-void extmoduleSendNextFramePxx1(const void* pulses, uint16_t length);
+bool extmoduleSendNextFramePxx1(const void* pulses, uint16_t length);
 #endif
 
 // Soft serial on PPM pin
 void extmoduleSerialStart();
 
-void extmoduleSendNextFramePpm(void* pulses, uint16_t length,
+// The frame senders return false when the previous frame is still
+// being sent: the new frame is then skipped, and its buffer not sent
+bool extmoduleSendNextFramePpm(void* pulses, uint16_t length,
                                uint16_t ppm_delay, bool polarity);
 
-void extmoduleSendNextFrameSoftSerial(const void* pulses, uint16_t length,
+bool extmoduleSendNextFrameSoftSerial(const void* pulses, uint16_t length,
                                       bool polarity = true);
 
 // Bitbang serial
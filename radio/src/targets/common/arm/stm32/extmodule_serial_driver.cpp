@@ -25,9 +25,11 @@
 
 #if defined(EXTMODULE_USART)
 #include "stm32_usart_driver.h"
+#include "rtos.h"
 
 #include "io/frsky_pxx2.h"
 ModuleFifo extmoduleFifo;
+static UsartTxFifo extmoduleTxFifo;
 
 static etx_serial_callbacks_t extmodule_driver = {
   nullptr, nullptr, nullptr
@@ -67,6 +69,7 @@ static const stm32_usart_t extmoduleUSART = {
   .rxDMA = nullptr,
   .rxDMA_Stream = 0,
   .rxDMA_Channel = 0,
+  .txFifo = &extmoduleTxFifo,
 };
 
 static void* extmoduleSerialStart(const etx_serial_init* params)
@@ -110,20 +113,26 @@ void extmoduleSerialStop(void*)
   extmodule_driver.on_error = nullptr;
 }
 
+// Only called from tasks: waits for room in the TX FIFO without spinning
 static void extmoduleSendByte(void*, uint8_t byte)
 {
-  stm32_usart_send_byte(&extmoduleUSART, byte);
+  while (!stm32_usart_send_byte(&extmoduleUSART, byte)) {
+    RTOS_WAIT_MS(1);
+  }
 }
 
 static void extmoduleSendBuffer(void*, const uint8_t * data, uint8_t size)
 {
   if (size == 0) return;
+  // A frame which does not fit is dropped, the module gets the next one
   stm32_usart_send_buffer(&extmoduleUSART, data, size);
 }
 
 static void extmoduleWaitForTxCompleted(void*)
 {
-  stm32_usart_wait_for_tx_dma(&extmoduleUSART);
+  while (stm32_usart_tx_busy(&extmoduleUSART)) {
+    RTOS_WAIT_MS(1);
+  }
 }
 
 const etx_serial_driver_t ExtmoduleSerialDriver = {
@@ -133,6 +142,7 @@ const etx_serial_driver_t ExtmoduleSerialDriver = {
   .sendBuffer = extmoduleSendBuffer,
   .waitForTxCompleted = extmoduleWaitForTxCompleted,
   .getByte = nullptr,
+  .getBuffer = nullptr,
   .getBaudrate = nullptr,
   .setReceiveCb = nullptr,
   .setBaudrateCb = nullptr,
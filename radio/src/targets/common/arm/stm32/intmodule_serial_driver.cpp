@@ -24,33 +24,13 @@
 #include "stm32_usart_driver.h"
 #include "board.h"
 #include "fifo.h"
+#include "rtos.h"
 
 Fifo<uint8_t, INTMODULE_FIFO_SIZE> intmoduleFifo;
-
-#if !defined(INTMODULE_DMA_STREAM)
-static uint8_t * intmoduleTxBufferData;
-static volatile uint8_t intmoduleTxBufferRemaining;
-
-uint8_t intmoduleTxBufferSend(uint8_t* data)
-{
-  if (intmoduleTxBufferRemaining) {
-    *data = *(intmoduleTxBufferData++);
-    intmoduleTxBufferRemaining--;
-    return true;
-  }
-
-  // buffer is empty
-  return false;
-}
-#endif
+static UsartTxFifo intmoduleTxFifo;
 
 static etx_serial_callbacks_t intmodule_driver = {
-#if !defined(INTMODULE_DMA_STREAM)
-  intmoduleTxBufferSend,
-#else
-  nullptr,
-#endif
-  nullptr, nullptr
+  nullptr, nullptr, nullptr
 };
 
 // TODO: move this somewhere else
@@ -80,6 +60,7 @@ static const stm32_usart_t intmoduleUSART = {
   .rxDMA = nullptr,
   .rxDMA_Stream = 0,
   .rxDMA_Channel = 0,
+  .txFifo = &intmoduleTxFifo,
 };
 
 void intmoduleStop()
@@ -118,10 +99,13 @@ extern "C" void INTMODULE_USART_IRQHandler(void)
   stm32_usart_isr(&intmoduleUSART, &intmodule_driver);
 }
 
+// Only called from tasks: waits for room in the TX FIFO without spinning
 void intmoduleSendByte(void* ctx, uint8_t byte)
 {
   (void)ctx;
-  stm32_usart_send_byte(&intmoduleUSART, byte);
+  while (!stm32_usart_send_byte(&intmoduleUSART, byte)) {
+    RTOS_WAIT_MS(1);
+  }
 }
 
 void intmoduleSendBuffer(void* ctx, const uint8_t * data, uint8_t size)
@@ -130,21 +114,16 @@ void intmoduleSendBuffer(void* ctx, const uint8_t * data, uint8_t size)
   if (size == 0)
     return;
 
-#if !defined(INTMODULE_DMA_STREAM)
-  intmoduleTxBufferData = (uint8_t *)data;
-  intmoduleTxBufferRemaining = size;
-#endif
+  // A frame which does not fit is dropped, the module gets the next one
   stm32_usart_send_buffer(&intmoduleUSART, data, size);
 }
 
 void intmoduleWaitForTxCompleted(void* ctx)
 {
   (void)ctx;
-#if defined(INTMODULE_DMA_STREAM)
-  stm32_usart_wait_for_tx_dma(&intmoduleUSART);
-#else
-  while (intmoduleTxBufferRemaining > 0);
-#endif
+  while (stm32_usart_tx_busy(&intmoduleUSART)) {
+    RTOS_WAIT_MS(1);
+  }
 }
 
 const etx_serial_driver_t IntmoduleSerialDriver = {
@@ -154,6 +133,7 @@ const etx_serial_driver_t IntmoduleSerialDriver = {
   .sendBuffer = intmoduleSendBuffer,
   .waitForTxCompleted = intmoduleWaitForTxCompleted,
   .getByte = nullptr,
+  .getBuffer = nullptr,
   .getBaudrate = nullptr,
   .setReceiveCb = nullptr,
   .setBaudrateCb = nullptr,
@@ -22,6 +22,33 @@
 #include "stm32_usart_driver.h"
 #include <string.h>
 
+// Clears all the interrupt flags of a DMA stream
+static void stm32_dma_clear_flags(DMA_TypeDef* DMAx, uint32_t stream)
+{
+  static const uint8_t offsets[] = { 0, 6, 16, 22 };
+  uint32_t mask = 0x3Du << offsets[stream & 3];
+  if (stream < LL_DMA_STREAM_4)
+    DMAx->LIFCR = mask;
+  else
+    DMAx->HIFCR = mask;
+}
+
+// The TX stream is configured once, sending a buffer
+// then only needs to set its address and length
+static void stm32_usart_init_tx_dma(const stm32_usart_t* usart)
+{
+  LL_DMA_DeInit(usart->txDMA, usart->txDMA_Stream);
+
+  LL_DMA_InitTypeDef dmaInit;
+  LL_DMA_StructInit(&dmaInit);
+  dmaInit.Channel = usart->txDMA_Channel;
+  dmaInit.PeriphOrM2MSrcAddress = (uint32_t)&usart->USARTx->DR;
+  dmaInit.Direction = LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+  dmaInit.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
+  dmaInit.Priority = LL_DMA_PRIORITY_VERYHIGH; // TODO: make it configurable
+  LL_DMA_Init(usart->txDMA, usart->txDMA_Stream, &dmaInit);
+}
+
 void stm32_usart_init_rx_dma(const stm32_usart_t* usart, void* buffer, uint32_t length)
 {
   if (!usart->rxDMA) return;
@@ -29,8 +56,8 @@ void stm32_usart_init_rx_dma(const stm32_usart_t* usart, void* buffer, uint32_t
   // Disable IRQ based RX
   LL_USART_DisableIT_RXNE(usart->USARTx);
 
-  // In case TX DMA is used, disable the ISR completely
-  if (usart->txDMA) {
+  // In case TX DMA is used without TX FIFO, disable the ISR completely
+  if (usart->txDMA && !usart->txFifo) {
     NVIC_DisableIRQ(usart->IRQn);
   }
 
@@ -113,8 +140,13 @@ void stm32_usart_init(const stm32_usart_t* usart, const etx_serial_init* params)
   LL_USART_Init(usart->USARTx, &usartInit);
   LL_USART_Enable(usart->USARTx);
 
+  if (usart->txFifo) {
+    usart->txFifo->clear();
+  }
+
   // Enable TX DMA request
   if (usart->txDMA) {
+    stm32_usart_init_tx_dma(usart);
     LL_USART_EnableDMAReq_TX(usart->USARTx);
   }
 
@@ -124,7 +156,8 @@ void stm32_usart_init(const stm32_usart_t* usart, const etx_serial_init* params)
     LL_USART_EnableIT_RXNE(usart->USARTx);
   }
 
-  if (!usart->txDMA || (params->rx_enable && !usart->rxDMA)) {
+  // The IRQ is needed for IRQ based TX/RX, and to chain DMA transfers
+  if (!usart->txDMA || usart->txFifo || (params->rx_enable && !usart->rxDMA)) {
     NVIC_SetPriority(usart->IRQn, usart->IRQ_Prio);
     NVIC_EnableIRQ(usart->IRQn);
   }
@@ -139,6 +172,9 @@ void stm32_usart_deinit(const stm32_usart_t* usart)
     LL_DMA_DeInit(usart->txDMA, usart->txDMA_Stream);
   }
   NVIC_DisableIRQ(usart->IRQn);
+  if (usart->txFifo) {
+    usart->txFifo->clear();
+  }
   LL_USART_DeInit(usart->USARTx);
 
   // Reconfigure pin as output
@@ -151,70 +187,69 @@ void stm32_usart_deinit(const stm32_usart_t* usart)
   LL_GPIO_ResetOutputPin(usart->GPIOx, pinInit.Pin);
 }
 
-void stm32_usart_send_byte(const stm32_usart_t* usart, uint8_t byte)
+// Starts the DMA transfer of the next chunk queued in the TX FIFO,
+// the stream must be disabled (previous transfer completed)
+static void stm32_usart_start_tx_dma(const stm32_usart_t* usart)
 {
-  // TODO: split into 2 steps to avoid blocking on send
-  while (!LL_USART_IsActiveFlag_TXE(usart->USARTx));
-  LL_USART_TransmitData8(usart->USARTx, byte);
+  const uint8_t* data;
+  uint32_t size;
+  if (!usart->txFifo->nextChunk(data, size)) {
+    LL_USART_DisableIT_TC(usart->USARTx);
+    return;
+  }
+
+  stm32_dma_clear_flags(usart->txDMA, usart->txDMA_Stream);
+  LL_DMA_SetMemoryAddress(usart->txDMA, usart->txDMA_Stream, (uint32_t)data);
+  LL_DMA_SetDataLength(usart->txDMA, usart->txDMA_Stream, size);
+
+  // TC is raised once the last byte of the chunk has left the USART
+  LL_USART_ClearFlag_TC(usart->USARTx);
+  LL_USART_EnableIT_TC(usart->USARTx);
+  LL_DMA_EnableStream(usart->txDMA, usart->txDMA_Stream);
 }
 
-void stm32_usart_send_buffer(const stm32_usart_t* usart, const uint8_t * data, uint32_t size)
+// Starts draining the TX FIFO, unless a transfer is running: the
+// next chunks are then chained from the USART IRQ
+static void stm32_usart_start_tx(const stm32_usart_t* usart)
 {
-  if (usart->txDMA) {
-    LL_DMA_DeInit(usart->txDMA, usart->txDMA_Stream);
-
-    LL_DMA_InitTypeDef dmaInit;
-    LL_DMA_StructInit(&dmaInit);
+  if (!usart->txDMA) {
+    LL_USART_EnableIT_TXE(usart->USARTx);
+    return;
+  }
 
-    dmaInit.Channel = usart->txDMA_Channel;
-    dmaInit.PeriphOrM2MSrcAddress = (uint32_t)&usart->USARTx->DR;
-    dmaInit.Direction = LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
-    dmaInit.MemoryOrM2MDstAddress = (uint32_t)data;
-    dmaInit.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
-    dmaInit.NbData = size;
-    dmaInit.Priority = LL_DMA_PRIORITY_VERYHIGH; // TODO: make it configurable
+  __disable_irq();
+  if (!LL_USART_IsEnabledIT_TC(usart->USARTx)) {
+    stm32_usart_start_tx_dma(usart);
+  }
+  __enable_irq();
+}
 
-    LL_DMA_Init(usart->txDMA, usart->txDMA_Stream, &dmaInit);
-    LL_DMA_EnableStream(usart->txDMA, usart->txDMA_Stream);
+bool stm32_usart_send_byte(const stm32_usart_t* usart, uint8_t byte)
+{
+  return stm32_usart_send_buffer(usart, &byte, 1);
+}
 
-    return;
-  } else {
-    // Please note that we don't use the buffer:
-    // it should be set internally by the driver user
-    // and each byte is returned individually by on_send()
-    LL_USART_EnableIT_TXE(usart->USARTx);
+bool stm32_usart_send_buffer(const stm32_usart_t* usart, const uint8_t * data, uint32_t size)
+{
+  if (usart->txFifo) {
+    if (!usart->txFifo->write(data, size)) {
+      return false;
+    }
   }
+  // Without TX FIFO, the buffer is set internally by the driver
+  // user and each byte is returned individually by on_send()
+  stm32_usart_start_tx(usart);
+  return true;
 }
 
-void stm32_usart_wait_for_tx_dma(const stm32_usart_t* usart)
+bool stm32_usart_tx_busy(const stm32_usart_t* usart)
 {
-  // TODO: check if everything is properly initialised, this seems to block when
-  //       the port has been initialised with a zero baudrate
-  if (LL_DMA_IsEnabledStream(usart->txDMA, usart->txDMA_Stream)) {
-
-    switch(usart->txDMA_Stream) {
-    case LL_DMA_STREAM_1:
-      while (LL_DMA_IsActiveFlag_TC1(usart->txDMA));
-      LL_DMA_ClearFlag_TC1(usart->txDMA);
-      break;
-    case LL_DMA_STREAM_3:
-      while (LL_DMA_IsActiveFlag_TC3(usart->txDMA));
-      LL_DMA_ClearFlag_TC3(usart->txDMA);
-      break;
-    case LL_DMA_STREAM_5:
-      while (LL_DMA_IsActiveFlag_TC5(usart->txDMA));
-      LL_DMA_ClearFlag_TC5(usart->txDMA);
-      break;
-    case LL_DMA_STREAM_6:
-      while (LL_DMA_IsActiveFlag_TC6(usart->txDMA));
-      LL_DMA_ClearFlag_TC6(usart->txDMA);
-      break;
-    case LL_DMA_STREAM_7:
-      while (LL_DMA_IsActiveFlag_TC7(usart->txDMA));
-      LL_DMA_ClearFlag_TC7(usart->txDMA);
-      break;
-    }
+  if (usart->txFifo && usart->txFifo->isBusy()) {
+    return true;
   }
+  // wait for the last byte to leave the shift register
+  return LL_USART_IsEnabledIT_TXE(usart->USARTx) ||
+         !LL_USART_IsActiveFlag_TC(usart->USARTx);
 }
 
 #define USART_FLAG_ERRORS \
@@ -246,11 +281,23 @@ void stm32_usart_isr(const stm32_usart_t* usart, etx_serial_callbacks_t* cb)
     }
   }
 
+  // DMA based send: chain the next chunk once the previous one is sent
+  if (LL_USART_IsEnabledIT_TC(usart->USARTx) && (status & LL_USART_SR_TC)) {
+    if (!LL_DMA_IsEnabledStream(usart->txDMA, usart->txDMA_Stream)) {
+      usart->txFifo->chunkDone();
+      stm32_usart_start_tx_dma(usart);
+    }
+    else {
+      LL_USART_ClearFlag_TC(usart->USARTx);
+    }
+  }
+
   // IRQ based send: TXE IRQ is enabled only during transfer
   if (LL_USART_IsEnabledIT_TXE(usart->USARTx) && (status & LL_USART_SR_TXE)) {
 
     uint8_t data;
-    if (cb->on_send && cb->on_send(&data)) {
+    if (usart->txFifo ? usart->txFifo->pop(data)
+                      : (cb->on_send && cb->on_send(&data))) {
       LL_USART_TransmitData8(usart->USARTx, data);
     } else {
       LL_USART_DisableIT_TXE(usart->USARTx);
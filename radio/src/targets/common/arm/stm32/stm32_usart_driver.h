@@ -24,6 +24,11 @@
 #include <stdint.h>
 #include "hal/serial_driver.h"
 #include "stm32_hal_ll.h"
+#include "serial_tx_fifo.h"
+
+// Large enough for any buffer passed to sendBuffer()
+#define USART_TX_FIFO_SIZE 256
+typedef SerialTxFifo<USART_TX_FIFO_SIZE> UsartTxFifo;
 
 struct stm32_usart_t {
 
@@ -45,14 +50,21 @@ struct stm32_usart_t {
     DMA_TypeDef*               rxDMA;
     uint32_t                   rxDMA_Stream;
     uint32_t                   rxDMA_Channel;
+
+    // TX FIFO, drained by DMA (or by the TXE IRQ without TX DMA).
+    // Without it, the bytes to send are returned by on_send()
+    UsartTxFifo*               txFifo;
 };
 
 void stm32_usart_init(const stm32_usart_t* usart, const etx_serial_init* params);
 void stm32_usart_init_rx_dma(const stm32_usart_t* usart, void* buffer, uint32_t length);
 void stm32_usart_deinit(const stm32_usart_t* usart);
 void stm32_usart_deinit_rx_dma(const stm32_usart_t* usart);
-void stm32_usart_send_byte(const stm32_usart_t* usart, uint8_t byte);
-void stm32_usart_send_buffer(const stm32_usart_t* usart, const uint8_t * data, uint32_t size);
-void stm32_usart_wait_for_tx_dma(const stm32_usart_t* usart);
+
+// Both return false, without waiting, when the TX FIFO is full
+bool stm32_usart_send_byte(const stm32_usart_t* usart, uint8_t byte);
+bool stm32_usart_send_buffer(const stm32_usart_t* usart, const uint8_t * data, uint32_t size);
+
+bool stm32_usart_tx_busy(const stm32_usart_t* usart);
 void stm32_usart_isr(const stm32_usart_t* usart, etx_serial_callbacks_t* cb);
 
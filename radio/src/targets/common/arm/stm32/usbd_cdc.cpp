@@ -303,6 +303,7 @@ static const etx_serial_driver_t usbSerialDriver = {
   nullptr,
   nullptr,
   nullptr,
+  nullptr,
   usbSerialBaudRate,
   usbSerialSetReceiveDataCb,
   usbSerialSetBaudRateCb,
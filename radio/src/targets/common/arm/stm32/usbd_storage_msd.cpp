@@ -220,8 +220,15 @@ int8_t STORAGE_Read (uint8_t lun,
     return (fat12Read(buf, blk_addr, blk_len) == 0) ? 0 : -1;
   }
 
+#if defined(DISK_CACHE)
+  // FatFs is not mounted while the USB mass storage runs, so its cache
+  // is used to read ahead: a miss fills a whole cache block with a single
+  // multi-block read, which serves the next sequential requests
+  return (diskCache.read(0, buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#else
   // read without cache
   return (__disk_read(0, buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#endif
 }
 /**
   * @brief  Write data to the medium
@@ -243,8 +250,13 @@ int8_t STORAGE_Write (uint8_t lun,
     return (fat12Write(buf, blk_addr, blk_len) == 0) ? 0 : -1;
   }
 
+#if defined(DISK_CACHE)
+  // write through, invalidating the blocks read ahead
+  return (diskCache.write(0, buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#else
   // write without cache
   return (__disk_write(0, buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#endif
 }
 
 /**
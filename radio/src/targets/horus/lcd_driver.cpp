@@ -231,16 +231,12 @@ void LCD_Init_LTDC()
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init( &NVIC_InitStructure );
 
-#if 0
-  DMA2D_ITConfig(DMA2D_CR_TCIE, ENABLE);
+  // DMA2D transfer complete interrupt chains the queued operations
   NVIC_InitStructure.NVIC_IRQChannel = DMA2D_IRQn;
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = DMA_SCREEN_IRQ_PRIO;
-  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0; /* Not used as 4 bits are used for the pr     e-emption priority. */;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0; /* Not used as 4 bits are used for the pre-emption priority. */
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init( &NVIC_InitStructure );
-
-  DMA2D->IFCR = (unsigned long)DMA2D_IFSR_CTCIF;
-#endif
 }
 
 void LCD_LayerInit()
@@ -345,6 +341,106 @@ void lcdInit()
   LTDC_Cmd(ENABLE);
 }
 
+// DMA2D operations are queued and chained from the transfer complete
+// interrupt: the CPU only waits when it needs the result (DMAWait()).
+// Outside of a DMABatchBegin() / DMABatchEnd() block, each operation
+// is still waited for before returning, as the caller may access
+// the same pixels right after.
+struct Dma2dCommand {
+  uint32_t cr;
+  uint32_t opfccr;
+  uint32_t ocolr;
+  uint32_t omar;
+  uint32_t oor;
+  uint32_t nlr;
+  uint32_t fgmar;
+  uint32_t fgor;
+  uint32_t fgpfccr;
+  uint32_t fgcolr;
+  uint32_t bgmar;
+  uint32_t bgor;
+  uint32_t bgpfccr;
+};
+
+#define DMA2D_QUEUE_SIZE               16
+
+static Dma2dCommand dma2dQueue[DMA2D_QUEUE_SIZE];
+static volatile uint8_t dma2dQueueHead = 0; // running command
+static volatile uint8_t dma2dQueueTail = 0; // first free slot
+static volatile bool dma2dBusy = false;
+static uint8_t dma2dBatchLevel = 0;
+
+static void dma2dStart(const Dma2dCommand & cmd)
+{
+  DMA2D->OPFCCR = cmd.opfccr;
+  DMA2D->OCOLR = cmd.ocolr;
+  DMA2D->OMAR = cmd.omar;
+  DMA2D->OOR = cmd.oor;
+  DMA2D->NLR = cmd.nlr;
+  DMA2D->FGMAR = cmd.fgmar;
+  DMA2D->FGOR = cmd.fgor;
+  DMA2D->FGPFCCR = cmd.fgpfccr;
+  DMA2D->FGCOLR = cmd.fgcolr;
+  DMA2D->BGMAR = cmd.bgmar;
+  DMA2D->BGOR = cmd.bgor;
+  DMA2D->BGPFCCR = cmd.bgpfccr;
+  DMA2D->CR = cmd.cr | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE | DMA2D_CR_START;
+}
+
+extern "C" void DMA2D_IRQHandler(void)
+{
+  DMA2D->IFCR = DMA2D_IFSR_CTCIF | DMA2D_IFSR_CTEIF | DMA2D_IFSR_CCEIF;
+
+  uint8_t head = (dma2dQueueHead + 1) % DMA2D_QUEUE_SIZE;
+  dma2dQueueHead = head;
+  if (head != dma2dQueueTail) {
+    dma2dStart(dma2dQueue[head]);
+  }
+  else {
+    dma2dBusy = false;
+  }
+}
+
+void DMAWait()
+{
+  while (dma2dBusy);
+}
+
+void DMABatchBegin()
+{
+  dma2dBatchLevel++;
+}
+
+void DMABatchEnd()
+{
+  if (dma2dBatchLevel > 0 && --dma2dBatchLevel == 0) {
+    DMAWait();
+  }
+}
+
+static void dma2dPush(const Dma2dCommand & cmd)
+{
+  uint8_t tail = dma2dQueueTail;
+  uint8_t next = (tail + 1) % DMA2D_QUEUE_SIZE;
+
+  // queue full: wait for the running command to complete
+  while (next == dma2dQueueHead);
+
+  dma2dQueue[tail] = cmd;
+
+  NVIC_DisableIRQ(DMA2D_IRQn);
+  dma2dQueueTail = next;
+  if (!dma2dBusy) {
+    dma2dBusy = true;
+    dma2dStart(dma2dQueue[tail]);
+  }
+  NVIC_EnableIRQ(DMA2D_IRQn);
+
+  if (dma2dBatchLevel == 0) {
+    DMAWait();
+  }
+}
+
 void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
 #if defined(LCD_VERTICAL_INVERT)
@@ -352,30 +448,14 @@ void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, ui
   y = desth - (y + h);
 #endif
 
-  DMA2D_DeInit();
-
-  DMA2D_InitTypeDef DMA2D_InitStruct;
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_R2M;
-  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;
-  DMA2D_InitStruct.DMA2D_OutputGreen = (0x07E0 & color) >> 5;
-  DMA2D_InitStruct.DMA2D_OutputBlue = 0x001F & color;
-  DMA2D_InitStruct.DMA2D_OutputRed = (0xF800 & color) >> 11;
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0x0F;
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CONVERT_PTR_UINT(dest) + 2*(destw*y + x);
-  DMA2D_InitStruct.DMA2D_OutputOffset = (destw - w);
-  DMA2D_InitStruct.DMA2D_NumberOfLine = h;
-  DMA2D_InitStruct.DMA2D_PixelPerLine = w;
-  DMA2D_Init(&DMA2D_InitStruct);
-
-  /* Start Transfer */
-  DMA2D_StartTransfer();
-
-  /* Check configuration error */
-  if ((DMA2D_GetFlagStatus(DMA2D_FLAG_CE) == SET) || (DMA2D_GetFlagStatus(DMA2D_FLAG_TE) == SET))
-    return; // Exit if configuration or transfer error
-  
-  /* Wait for CTC Flag activation */
-  while (DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET);
+  Dma2dCommand cmd = {};
+  cmd.cr = DMA2D_R2M;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.ocolr = color;
+  cmd.omar = CONVERT_PTR_UINT(dest) + 2*(destw*y + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  dma2dPush(cmd);
 }
 
 void DMACopyBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h)
@@ -387,39 +467,16 @@ void DMACopyBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x,
   srcy = srch - (srcy + h);
 #endif
 
-  DMA2D_DeInit();
-
-  DMA2D_InitTypeDef DMA2D_InitStruct;
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M;
-  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CONVERT_PTR_UINT(dest + y*destw + x);
-  DMA2D_InitStruct.DMA2D_OutputGreen = 0;
-  DMA2D_InitStruct.DMA2D_OutputBlue = 0;
-  DMA2D_InitStruct.DMA2D_OutputRed = 0;
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
-  DMA2D_InitStruct.DMA2D_OutputOffset = destw - w;
-  DMA2D_InitStruct.DMA2D_NumberOfLine = h;
-  DMA2D_InitStruct.DMA2D_PixelPerLine = w;
-  DMA2D_Init(&DMA2D_InitStruct);
-
-  DMA2D_FG_InitTypeDef DMA2D_FG_InitStruct;
-  DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
-  DMA2D_FG_InitStruct.DMA2D_FGMA = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
-  DMA2D_FG_InitStruct.DMA2D_FGO = srcw - w;
-  DMA2D_FG_InitStruct.DMA2D_FGCM = CM_RGB565;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_MODE = NO_MODIF_ALPHA_VALUE;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_VALUE = 0;
-  DMA2D_FGConfig(&DMA2D_FG_InitStruct);
-
-  /* Start Transfer */
-  DMA2D_StartTransfer();
-
-  /* Check configuration error */
-  if ((DMA2D_GetFlagStatus(DMA2D_FLAG_CE) == SET) || (DMA2D_GetFlagStatus(DMA2D_FLAG_TE) == SET))
-    return; // Exit if configuration or transfer error
-
-  /* Wait for CTC Flag activation */
-  while (DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET);
+  Dma2dCommand cmd = {};
+  cmd.cr = DMA2D_M2M;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
+  cmd.fgor = srcw - w;
+  cmd.fgpfccr = CM_RGB565 | (NO_MODIF_ALPHA_VALUE << 16);
+  dma2dPush(cmd);
 }
 
 void DMACopyAlphaBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h)
@@ -431,48 +488,19 @@ void DMACopyAlphaBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_
   srcy = srch - (srcy + h);
 #endif
 
-  DMA2D_DeInit();
-
-  DMA2D_InitTypeDef DMA2D_InitStruct;
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M_BLEND;
-  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CONVERT_PTR_UINT(dest + y*destw + x);
-  DMA2D_InitStruct.DMA2D_OutputGreen = 0;
-  DMA2D_InitStruct.DMA2D_OutputBlue = 0;
-  DMA2D_InitStruct.DMA2D_OutputRed = 0;
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
-  DMA2D_InitStruct.DMA2D_OutputOffset = destw - w;
-  DMA2D_InitStruct.DMA2D_NumberOfLine = h;
-  DMA2D_InitStruct.DMA2D_PixelPerLine = w;
-  DMA2D_Init(&DMA2D_InitStruct);
-
-  DMA2D_FG_InitTypeDef DMA2D_FG_InitStruct;
-  DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
-  DMA2D_FG_InitStruct.DMA2D_FGMA = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
-  DMA2D_FG_InitStruct.DMA2D_FGO = srcw - w;
-  DMA2D_FG_InitStruct.DMA2D_FGCM = CM_ARGB4444;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_MODE = NO_MODIF_ALPHA_VALUE;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_VALUE = 0;
-  DMA2D_FGConfig(&DMA2D_FG_InitStruct);
-
-  DMA2D_BG_InitTypeDef DMA2D_BG_InitStruct;
-  DMA2D_BG_StructInit(&DMA2D_BG_InitStruct);
-  DMA2D_BG_InitStruct.DMA2D_BGMA = CONVERT_PTR_UINT(dest + y*destw + x);
-  DMA2D_BG_InitStruct.DMA2D_BGO = destw - w;
-  DMA2D_BG_InitStruct.DMA2D_BGCM = CM_RGB565;
-  DMA2D_BG_InitStruct.DMA2D_BGPFC_ALPHA_MODE = NO_MODIF_ALPHA_VALUE;
-  DMA2D_BG_InitStruct.DMA2D_BGPFC_ALPHA_VALUE = 0;
-  DMA2D_BGConfig(&DMA2D_BG_InitStruct);
-
-  /* Start Transfer */
-  DMA2D_StartTransfer();
-
-  /* Check configuration error */
-  if ((DMA2D_GetFlagStatus(DMA2D_FLAG_CE) == SET) || (DMA2D_GetFlagStatus(DMA2D_FLAG_TE) == SET))
-    return; // Exit if configuration or transfer error
-
-  /* Wait for CTC Flag activation */
-  while (DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET);
+  Dma2dCommand cmd = {};
+  cmd.cr = DMA2D_M2M_BLEND;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
+  cmd.fgor = srcw - w;
+  cmd.fgpfccr = CM_ARGB4444 | (NO_MODIF_ALPHA_VALUE << 16);
+  cmd.bgmar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.bgor = destw - w;
+  cmd.bgpfccr = CM_RGB565 | (NO_MODIF_ALPHA_VALUE << 16);
+  dma2dPush(cmd);
 }
 
 // same as DMACopyAlphaBitmap(), but with an 8 bit mask for each pixel (used by fonts)
@@ -485,126 +513,47 @@ void DMACopyAlphaMask(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t
   srcy = srch - (srcy + h);
 #endif
 
-  DMA2D_DeInit();
-
-  DMA2D_InitTypeDef DMA2D_InitStruct;
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M_BLEND;
-  DMA2D_InitStruct.DMA2D_CMode = CM_RGB565;
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CONVERT_PTR_UINT(dest + y*destw + x);
-  DMA2D_InitStruct.DMA2D_OutputBlue = 0;
-  DMA2D_InitStruct.DMA2D_OutputGreen = 0;
-  DMA2D_InitStruct.DMA2D_OutputRed = 0;
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
-  DMA2D_InitStruct.DMA2D_OutputOffset = destw - w;
-  DMA2D_InitStruct.DMA2D_NumberOfLine = h;
-  DMA2D_InitStruct.DMA2D_PixelPerLine = w;
-  DMA2D_Init(&DMA2D_InitStruct);
-
-  DMA2D_FG_InitTypeDef DMA2D_FG_InitStruct;
-  DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
-  DMA2D_FG_InitStruct.DMA2D_FGMA = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
-  DMA2D_FG_InitStruct.DMA2D_FGO = srcw - w;
-  DMA2D_FG_InitStruct.DMA2D_FGCM = CM_A8; // 8 bit inputs every time
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_MODE = NO_MODIF_ALPHA_VALUE;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_VALUE = 0;
-  DMA2D_FG_InitStruct.DMA2D_FGC_RED   = GET_RED(bg_color);   // 8 bit red
-  DMA2D_FG_InitStruct.DMA2D_FGC_GREEN = GET_GREEN(bg_color); // 8 bit green
-  DMA2D_FG_InitStruct.DMA2D_FGC_BLUE  = GET_BLUE(bg_color);  // 8 bit blue
-  
-  DMA2D_FGConfig(&DMA2D_FG_InitStruct);
-
-  DMA2D_BG_InitTypeDef DMA2D_BG_InitStruct;
-  DMA2D_BG_StructInit(&DMA2D_BG_InitStruct);
-  DMA2D_BG_InitStruct.DMA2D_BGMA = CONVERT_PTR_UINT(dest + y*destw + x);
-  DMA2D_BG_InitStruct.DMA2D_BGO = destw - w;
-  DMA2D_BG_InitStruct.DMA2D_BGCM = CM_RGB565;
-  DMA2D_BG_InitStruct.DMA2D_BGPFC_ALPHA_MODE = NO_MODIF_ALPHA_VALUE;
-  DMA2D_BG_InitStruct.DMA2D_BGPFC_ALPHA_VALUE = 0;
-  DMA2D_BGConfig(&DMA2D_BG_InitStruct);
-
-  /* Start Transfer */
-  DMA2D_StartTransfer();
-
-  /* Check configuration error */
-  if ((DMA2D_GetFlagStatus(DMA2D_FLAG_CE) == SET) || (DMA2D_GetFlagStatus(DMA2D_FLAG_TE) == SET))
-    return; // Exit if configuration or transfer error
- 
-  /* Wait for CTC Flag activation */
-  while (DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET);
+  Dma2dCommand cmd = {};
+  cmd.cr = DMA2D_M2M_BLEND;
+  cmd.opfccr = CM_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
+  cmd.fgor = srcw - w;
+  cmd.fgpfccr = CM_A8 | (NO_MODIF_ALPHA_VALUE << 16); // 8 bit inputs every time
+  cmd.fgcolr = (GET_RED(bg_color) << 16) | (GET_GREEN(bg_color) << 8) | GET_BLUE(bg_color);
+  cmd.bgmar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.bgor = destw - w;
+  cmd.bgpfccr = CM_RGB565 | (NO_MODIF_ALPHA_VALUE << 16);
+  dma2dPush(cmd);
 }
 
 void DMABitmapConvert(uint16_t * dest, const uint8_t * src, uint16_t w, uint16_t h, uint32_t format)
 {
-  DMA2D_DeInit();
-
-  DMA2D_InitTypeDef DMA2D_InitStruct;
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M_PFC;
-  DMA2D_InitStruct.DMA2D_CMode = format;
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CONVERT_PTR_UINT(dest);
-  DMA2D_InitStruct.DMA2D_OutputGreen = 0;
-  DMA2D_InitStruct.DMA2D_OutputBlue = 0;
-  DMA2D_InitStruct.DMA2D_OutputRed = 0;
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
-  DMA2D_InitStruct.DMA2D_OutputOffset = 0;
-  DMA2D_InitStruct.DMA2D_NumberOfLine = h;
-  DMA2D_InitStruct.DMA2D_PixelPerLine = w;
-  DMA2D_Init(&DMA2D_InitStruct);
-
-  DMA2D_FG_InitTypeDef DMA2D_FG_InitStruct;
-  DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
-  DMA2D_FG_InitStruct.DMA2D_FGMA = CONVERT_PTR_UINT(src);
-  DMA2D_FG_InitStruct.DMA2D_FGO = 0;
-  DMA2D_FG_InitStruct.DMA2D_FGCM = CM_ARGB8888;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_MODE = REPLACE_ALPHA_VALUE;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_VALUE = 0;
-  DMA2D_FGConfig(&DMA2D_FG_InitStruct);
-
-  /* Start Transfer */
-  DMA2D_StartTransfer();
-
-  /* Check configuration error */
-  if ((DMA2D_GetFlagStatus(DMA2D_FLAG_CE) == SET) || (DMA2D_GetFlagStatus(DMA2D_FLAG_TE) == SET))
-    return; // Exit if configuration or transfer error
-
-  /* Wait for CTC Flag activation */
-  while (DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET);
+  Dma2dCommand cmd = {};
+  cmd.cr = DMA2D_M2M_PFC;
+  cmd.opfccr = format;
+  cmd.omar = CONVERT_PTR_UINT(dest);
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src);
+  cmd.fgpfccr = CM_ARGB8888 | (REPLACE_ALPHA_VALUE << 16);
+  dma2dPush(cmd);
+
+  // the result is read by the CPU right after
+  DMAWait();
 }
 
 void lcdCopy(void * dest, void * src)
 {
-  DMA2D_DeInit();
-
-  DMA2D_InitTypeDef DMA2D_InitStruct;
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M;
-  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CONVERT_PTR_UINT(dest);
-  DMA2D_InitStruct.DMA2D_OutputGreen = 0;
-  DMA2D_InitStruct.DMA2D_OutputBlue = 0;
-  DMA2D_InitStruct.DMA2D_OutputRed = 0;
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
-  DMA2D_InitStruct.DMA2D_OutputOffset = 0;
-  DMA2D_InitStruct.DMA2D_NumberOfLine = LCD_H;
-  DMA2D_InitStruct.DMA2D_PixelPerLine = LCD_W;
-  DMA2D_Init(&DMA2D_InitStruct);
-
-  DMA2D_FG_InitTypeDef DMA2D_FG_InitStruct;
-  DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
-  DMA2D_FG_InitStruct.DMA2D_FGMA = CONVERT_PTR_UINT(src);
-  DMA2D_FG_InitStruct.DMA2D_FGO = 0;
-  DMA2D_FG_InitStruct.DMA2D_FGCM = CM_RGB565;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_MODE = NO_MODIF_ALPHA_VALUE;
-  DMA2D_FG_InitStruct.DMA2D_FGPFC_ALPHA_VALUE = 0;
-  DMA2D_FGConfig(&DMA2D_FG_InitStruct);
-
-  /* Start Transfer */
-  DMA2D_StartTransfer();
-
-  /* Check configuration error */
-  if ((DMA2D_GetFlagStatus(DMA2D_FLAG_CE) == SET) || (DMA2D_GetFlagStatus(DMA2D_FLAG_TE) == SET))
-    return; // Exit if configuration or transfer error
-  
-  /* Wait for CTC Flag activation */
-  while (DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET);
+  Dma2dCommand cmd = {};
+  cmd.cr = DMA2D_M2M;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest);
+  cmd.nlr = (LCD_W << 16) | LCD_H;
+  cmd.fgmar = CONVERT_PTR_UINT(src);
+  cmd.fgpfccr = CM_RGB565 | (NO_MODIF_ALPHA_VALUE << 16);
+  dma2dPush(cmd);
 }
 
 void lcdStoreBackupBuffer()
@@ -659,5 +608,7 @@ static void lcdSwitchLayers()
 
 void lcdRefresh()
 {
+  // all pending drawing must be done before displaying the buffer
+  DMAWait();
   lcdSwitchLayers();
 }
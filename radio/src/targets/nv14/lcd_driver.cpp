@@ -1360,6 +1360,11 @@ void lcdInit(void) {
   LTDC_ReloadConfig(LTDC_IMReload);
 }
 
+// DMA2D operations are synchronous on this target
+void DMAWait() {}
+void DMABatchBegin() {}
+void DMABatchEnd() {}
+
 void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
   DMA2D_DeInit();
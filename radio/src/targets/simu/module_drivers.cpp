@@ -44,9 +44,9 @@ void extmodulePxx1SerialStart() {}
 void extmodulePxx1PulsesStart() {}
 void extmoduleInitTxPin() {}
 void extmoduleSendInvertedByte(uint8_t) {}
-void extmoduleSendNextFramePxx1(void const*, unsigned short) {}
-void extmoduleSendNextFrameSoftSerial(void const*, unsigned short, bool) {}
-void extmoduleSendNextFramePpm(void*, unsigned short, unsigned short, bool) {}
+bool extmoduleSendNextFramePxx1(void const*, unsigned short) { return true; }
+bool extmoduleSendNextFrameSoftSerial(void const*, unsigned short, bool) { return true; }
+bool extmoduleSendNextFramePpm(void*, unsigned short, unsigned short, bool) { return true; }
 
 #if defined(TRAINER_GPIO)
 void init_trainer_ppm() {}
@@ -70,6 +70,7 @@ static void sendByte(void*, uint8_t) {}
 static void sendBuffer(void*, const uint8_t*, uint8_t) {}
 static void waitForTxCompleted(void*) {}
 static int getByte(void*,uint8_t*) { return -1; }
+static int getBuffer(void*,uint8_t*,uint32_t) { return 0; }
 
 const etx_serial_driver_t IntmoduleSerialDriver = {
     .init = init,
@@ -78,6 +79,7 @@ const etx_serial_driver_t IntmoduleSerialDriver = {
     .sendBuffer = sendBuffer,
     .waitForTxCompleted = waitForTxCompleted,
     .getByte = getByte,
+    .getBuffer = getBuffer,
     .getBaudrate = nullptr,
     .setReceiveCb = nullptr,
     .setBaudrateCb = nullptr,
@@ -90,6 +92,7 @@ const etx_serial_driver_t ExtmoduleSerialDriver = {
     .sendBuffer = sendBuffer,
     .waitForTxCompleted = waitForTxCompleted,
     .getByte = getByte,
+    .getBuffer = getBuffer,
     .getBaudrate = nullptr,
     .setReceiveCb = nullptr,
     .setBaudrateCb = nullptr,
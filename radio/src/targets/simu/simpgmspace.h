@@ -34,6 +34,12 @@ inline int __builtin_clz(unsigned x)
 {
     return (int)__lzcnt(x);
 }
+inline int __builtin_ctz(unsigned x)
+{
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (int)index;
+}
 #else
 #include <unistd.h>
 #define sleep(x) usleep(1000*x)
@@ -325,17 +325,36 @@ FRESULT f_open (FIL * fil, const TCHAR *name, BYTE flag)
   std::string path = convertToSimuPath(name);
   std::string realPath = findTrueFileName(path);
   fil->obj.fs = 0;
+  fil->flag = flag;
+#if FF_USE_FASTSEEK
+  fil->cltbl = nullptr;
+#endif
+  struct stat tmp;
+  bool exists = !stat(realPath.c_str(), &tmp);
   if (!(flag & FA_WRITE)) {
-    struct stat tmp;
-    if (stat(realPath.c_str(), &tmp)) {
+    if (!exists) {
       TRACE_SIMPGMSPACE("f_open(%s) = INVALID_NAME (FIL %p)", path.c_str(), fil);
       return FR_INVALID_NAME;
     }
     fil->obj.objsize = tmp.st_size;
     fil->fptr = 0;
   }
-  fil->obj.fs = (FATFS*)fopen(realPath.c_str(), (flag & FA_WRITE) ? ((flag & FA_CREATE_ALWAYS) ? "wb+" : "ab+") : "rb+");
+  // existing files opened for writing are not truncated and can be
+  // written anywhere with f_lseek(), as with FatFs
+  const char * mode = "rb+";
+  if ((flag & FA_WRITE) && ((flag & FA_CREATE_ALWAYS) || !exists)) {
+    if (!exists && !(flag & (FA_CREATE_ALWAYS | FA_OPEN_ALWAYS | FA_CREATE_NEW))) {
+      TRACE_SIMPGMSPACE("f_open(%s) = NO_FILE (FIL %p)", path.c_str(), fil);
+      return FR_NO_FILE;
+    }
+    mode = "wb+";
+  }
+  fil->obj.fs = (FATFS*)fopen(realPath.c_str(), mode);
   fil->fptr = 0;
+  if (fil->obj.fs && (flag & FA_OPEN_APPEND) == FA_OPEN_APPEND) {
+    fseek((FILE*)fil->obj.fs, 0, SEEK_END);
+    fil->fptr = ftell((FILE*)fil->obj.fs);
+  }
   if (fil->obj.fs) {
     TRACE_SIMPGMSPACE("f_open(%s, %x) = %p (FIL %p)", path.c_str(), flag, fil->obj.fs, fil);
     return FR_OK;
@@ -378,6 +397,22 @@ TCHAR * f_gets (TCHAR* buff, int len, FIL* fil)
 
 FRESULT f_lseek (FIL* fil, DWORD offset)
 {
+#if FF_USE_FASTSEEK
+  if (fil && fil->obj.fs && fil->cltbl) {
+    if (offset == CREATE_LINKMAP) {
+      // host files are seen as a single fragment
+      DWORD size = fil->cltbl[0];
+      fil->cltbl[0] = f_size(fil) ? 4 : 2;
+      if (fil->cltbl[0] > size) {
+        return FR_NOT_ENOUGH_CORE;
+      }
+      TRACE_SIMPGMSPACE("f_lseek(%p) link map created", fil->obj.fs);
+      return FR_OK;
+    }
+    // as FatFs, fast seek does not expand the file
+    offset = min<DWORD>(offset, f_size(fil));
+  }
+#endif
   if (fil && fil->obj.fs) {
     fseek((FILE*)fil->obj.fs, offset, SEEK_SET);
     fil->fptr = offset;
@@ -505,7 +540,7 @@ FRESULT f_unlink (const TCHAR * name)
   std::string path = convertToSimuPath(name);
   if (unlink(path.c_str())) {
     TRACE_SIMPGMSPACE("f_unlink(%s) = error %d (%s)", path.c_str(), errno, strerror(errno));
-    return FR_INVALID_NAME;
+    return errno == ENOENT ? FR_NO_FILE : FR_INVALID_NAME;
   }
   else {
     TRACE_SIMPGMSPACE("f_unlink(%s) = OK", path.c_str());
@@ -518,9 +553,18 @@ FRESULT f_rename(const TCHAR *oldname, const TCHAR *newname)
   std::string old = convertToSimuPath(oldname);
   std::string path = convertToSimuPath(newname);
 
+  // FatFs does not replace an existing file (renaming to the same name
+  // with a different case is fine)
+  struct stat src, dst;
+  if (!stat(path.c_str(), &dst) &&
+      (stat(old.c_str(), &src) || src.st_ino != dst.st_ino)) {
+    TRACE_SIMPGMSPACE("f_rename(%s, %s) = error (exists)", old.c_str(), path.c_str());
+    return FR_EXIST;
+  }
+
   if (rename(old.c_str(), path.c_str()) < 0) {
     TRACE_SIMPGMSPACE("f_rename(%s, %s) = error %d (%s)", old.c_str(), path.c_str(), errno, strerror(errno));
-    return FR_INVALID_NAME;
+    return errno == ENOENT ? FR_NO_FILE : FR_INVALID_NAME;
   }
   TRACE_SIMPGMSPACE("f_rename(%s, %s) = OK", old.c_str(), path.c_str());
   return FR_OK;
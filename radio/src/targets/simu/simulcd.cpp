@@ -22,6 +22,7 @@
 #include "lcd.h"
 #include "simulcd.h"
 #include <string.h>
+#include <functional>
 #include <utility>
 
 pixel_t simuLcdBuf[DISPLAY_BUFFER_SIZE];
@@ -70,12 +71,14 @@ uint16_t *lcdGetScratchBuffer() { return static_cast<uint16_t *>(scratchBuf); }
 
 void lcdStoreBackupBuffer()
 {
+  DMAWait();
   memcpy(simuLcdBackupBuf, lcd->getData(),
          DISPLAY_BUFFER_SIZE * sizeof(pixel_t));
 }
 
 int lcdRestoreBackupBuffer()
 {
+  DMAWait();
   memcpy(lcd->getData(), simuLcdBackupBuf,
          DISPLAY_BUFFER_SIZE * sizeof(pixel_t));
   return 1;
@@ -83,6 +86,9 @@ int lcdRestoreBackupBuffer()
 
 void lcdRefresh()
 {
+  // all pending drawing must be done before displaying the buffer
+  DMAWait();
+
   // Mark screen dirty for async refresh
   simuLcdRefresh = true;
 
@@ -110,8 +116,57 @@ void lcdInit()
   _lcd2.clear();
 }
 
-void DMAFillRect(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
-                 uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+// DMA operations go through a software queue, which is run at once on
+// DMAWait(), when full, or when no batch is open. This mimics the DMA2D
+// queue of the Horus driver, so that drawing batched by the GUI gives
+// the same pixels here as on the radio.
+#define DMA_QUEUE_SIZE                 16
+
+static std::function<void()> dmaQueue[DMA_QUEUE_SIZE];
+static uint8_t dmaQueueCount = 0;
+static uint8_t dmaBatchLevel = 0;
+
+void DMAWait()
+{
+  for (uint8_t i = 0; i < dmaQueueCount; i++) {
+    dmaQueue[i]();
+    dmaQueue[i] = nullptr;
+  }
+  dmaQueueCount = 0;
+}
+
+void DMABatchBegin()
+{
+  dmaBatchLevel++;
+}
+
+void DMABatchEnd()
+{
+  if (dmaBatchLevel > 0 && --dmaBatchLevel == 0) {
+    DMAWait();
+  }
+}
+
+uint8_t DMAPendingOperations()
+{
+  return dmaQueueCount;
+}
+
+static void dmaPush(std::function<void()> && operation)
+{
+  if (dmaQueueCount == DMA_QUEUE_SIZE) {
+    DMAWait();
+  }
+
+  dmaQueue[dmaQueueCount++] = std::move(operation);
+
+  if (dmaBatchLevel == 0) {
+    DMAWait();
+  }
+}
+
+static void simuFillRect(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
+                         uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
 #if defined(LCD_VERTICAL_INVERT)
   x = destw - (x + w);
@@ -125,10 +180,16 @@ void DMAFillRect(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
   }
 }
 
-void DMACopyBitmap(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
-                   uint16_t y, const uint16_t *src, uint16_t srcw,
-                   uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w,
-                   uint16_t h)
+void DMAFillRect(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
+                 uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  dmaPush([=]() { simuFillRect(dest, destw, desth, x, y, w, h, color); });
+}
+
+static void simuCopyBitmap(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
+                           uint16_t y, const uint16_t *src, uint16_t srcw,
+                           uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w,
+                           uint16_t h)
 {
 #if defined(LCD_VERTICAL_INVERT)
   x = destw - (x + w);
@@ -142,12 +203,22 @@ void DMACopyBitmap(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
   }
 }
 
+void DMACopyBitmap(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
+                   uint16_t y, const uint16_t *src, uint16_t srcw,
+                   uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w,
+                   uint16_t h)
+{
+  dmaPush([=]() {
+    simuCopyBitmap(dest, destw, desth, x, y, src, srcw, srch, srcx, srcy, w, h);
+  });
+}
+
 // 'src' has ARGB4444
 // 'dest' has RGB565
-void DMACopyAlphaBitmap(uint16_t *dest, uint16_t destw, uint16_t desth,
-                        uint16_t x, uint16_t y, const uint16_t *src,
-                        uint16_t srcw, uint16_t srch, uint16_t srcx,
-                        uint16_t srcy, uint16_t w, uint16_t h)
+static void simuCopyAlphaBitmap(uint16_t *dest, uint16_t destw, uint16_t desth,
+                                uint16_t x, uint16_t y, const uint16_t *src,
+                                uint16_t srcw, uint16_t srch, uint16_t srcx,
+                                uint16_t srcy, uint16_t w, uint16_t h)
 {
 #if defined(LCD_VERTICAL_INVERT)
   x = destw - (x + w);
@@ -177,12 +248,23 @@ void DMACopyAlphaBitmap(uint16_t *dest, uint16_t destw, uint16_t desth,
   }
 }
 
+void DMACopyAlphaBitmap(uint16_t *dest, uint16_t destw, uint16_t desth,
+                        uint16_t x, uint16_t y, const uint16_t *src,
+                        uint16_t srcw, uint16_t srch, uint16_t srcx,
+                        uint16_t srcy, uint16_t w, uint16_t h)
+{
+  dmaPush([=]() {
+    simuCopyAlphaBitmap(dest, destw, desth, x, y, src, srcw, srch, srcx, srcy,
+                        w, h);
+  });
+}
+
 // 'src' has A8/L8?
 // 'dest' has RGB565
-void DMACopyAlphaMask(uint16_t *dest, uint16_t destw, uint16_t desth,
-                      uint16_t x, uint16_t y, const uint8_t *src, uint16_t srcw,
-                      uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w,
-                      uint16_t h, uint16_t fg_color)
+static void simuCopyAlphaMask(uint16_t *dest, uint16_t destw, uint16_t desth,
+                              uint16_t x, uint16_t y, const uint8_t *src, uint16_t srcw,
+                              uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w,
+                              uint16_t h, uint16_t fg_color)
 {
 #if defined(LCD_VERTICAL_INVERT)
   x = destw - (x + w);
@@ -210,9 +292,23 @@ void DMACopyAlphaMask(uint16_t *dest, uint16_t destw, uint16_t desth,
   }
 }
 
+void DMACopyAlphaMask(uint16_t *dest, uint16_t destw, uint16_t desth,
+                      uint16_t x, uint16_t y, const uint8_t *src, uint16_t srcw,
+                      uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w,
+                      uint16_t h, uint16_t fg_color)
+{
+  dmaPush([=]() {
+    simuCopyAlphaMask(dest, destw, desth, x, y, src, srcw, srch, srcx, srcy, w,
+                      h, fg_color);
+  });
+}
+
 void DMABitmapConvert(uint16_t *dest, const uint8_t *src, uint16_t w,
                       uint16_t h, uint32_t format)
 {
+  // the result is read by the CPU right after
+  DMAWait();
+
   if (format == DMA2D_ARGB4444) {
     for (int row = 0; row < h; ++row) {
       for (int col = 0; col < w; ++col) {
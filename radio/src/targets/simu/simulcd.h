@@ -31,4 +31,11 @@ extern bool simuLcdRefresh;
 extern pixel_t simuLcdBuf[DISPLAY_BUFFER_SIZE];
 extern pixel_t displayBuf[DISPLAY_BUFFER_SIZE];
 
+#if defined(COLORLCD)
+// runs the queued DMA operations
+void DMAWait();
+// number of DMA operations queued and not run yet
+uint8_t DMAPendingOperations();
+#endif
+
 #endif // _SIMULCD_H_
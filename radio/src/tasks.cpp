@@ -35,6 +35,13 @@ RTOS_DEFINE_STACK(audioStack, AUDIO_STACK_SIZE);
 RTOS_MUTEX_HANDLE audioMutex;
 RTOS_MUTEX_HANDLE mixerMutex;
 
+#if defined(STORAGE_TASK)
+RTOS_MUTEX_HANDLE storageMutex;
+RTOS_FLAG_HANDLE storageFlag;
+RTOS_TASK_HANDLE storageTaskId;
+RTOS_DEFINE_STACK(storageStack, STORAGE_STACK_SIZE);
+#endif
+
 void stackPaint()
 {
   menusStack.paint();
@@ -43,6 +50,9 @@ void stackPaint()
 #if defined(CLI)
   cliStack.paint();
 #endif
+#if defined(STORAGE_TASK)
+  storageStack.paint();
+#endif
 }
 
 volatile uint16_t timeForcePowerOffPressed = 0;
@@ -245,10 +255,35 @@ TASK_FUNCTION(menusTask)
   TASK_RETURN();
 }
 
+#if defined(STORAGE_TASK)
+// only needed by the simulator to notice the power off
+#define STORAGE_TASK_TIMEOUT_MS        500
+
+// Writes the settings copies handed over by storageCheck(false), so that
+// the menus do not wait for the SD card. It runs below the menus, while they
+// sleep between two refreshes; they flush the copies themselves when needed.
+TASK_FUNCTION(storageTask)
+{
+  while (true) {
+    RTOS_WAIT_FLAG(storageFlag, STORAGE_TASK_TIMEOUT_MS);
+#if defined(SIMU)
+    if (pwrCheck() == e_power_off) {
+      TASK_RETURN();
+    }
+#endif
+    storageFlushPending();
+  }
+}
+#endif
+
 void tasksStart()
 {
   RTOS_CREATE_MUTEX(audioMutex);
   RTOS_CREATE_MUTEX(mixerMutex);
+#if defined(STORAGE_TASK)
+  RTOS_CREATE_MUTEX(storageMutex);
+  RTOS_CREATE_FLAG(storageFlag);
+#endif
 
 #if defined(CLI)
   cliStart();
@@ -259,6 +294,11 @@ void tasksStart()
   RTOS_CREATE_TASK(menusTaskId, menusTask, "menus", menusStack,
                    MENUS_STACK_SIZE, MENUS_TASK_PRIO);
 
+#if defined(STORAGE_TASK)
+  RTOS_CREATE_TASK(storageTaskId, storageTask, "storage", storageStack,
+                   STORAGE_STACK_SIZE, STORAGE_TASK_PRIO);
+#endif
+
 #if !defined(SIMU)
   RTOS_CREATE_TASK(audioTaskId, audioTask, "audio", audioStack,
                    AUDIO_STACK_SIZE, AUDIO_TASK_PRIO);
@@ -33,17 +33,24 @@
 #define MIXER_STACK_SIZE       400
 #define AUDIO_STACK_SIZE       400
 #define CLI_STACK_SIZE         1024  // only consumed with CLI build option
+// a model write needs about 3.7 KB of stack: writeFileYaml() with its FIL,
+// path and tree walker (~1 KB), the headers index update in writeModel()
+// (~0.9 KB), FatFs f_open() / f_rename() with their LFN buffer (~1.2 KB),
+// then callers, SD driver and context switch; 1200 words leave ~1 KB
+#define STORAGE_STACK_SIZE     1200  // only consumed with STORAGE_TASK
 
 #if defined(FREE_RTOS)
 #define MIXER_TASK_PRIO        (tskIDLE_PRIORITY + 4)
 #define AUDIO_TASK_PRIO        (tskIDLE_PRIORITY + 2)
 #define MENUS_TASK_PRIO        (tskIDLE_PRIORITY + 1)
 #define CLI_TASK_PRIO          (tskIDLE_PRIORITY + 1)
+#define STORAGE_TASK_PRIO      (tskIDLE_PRIORITY)
 #else
 #define MIXER_TASK_PRIO        (4)
 #define AUDIO_TASK_PRIO        (2)
 #define MENUS_TASK_PRIO        (1)
 #define CLI_TASK_PRIO          (1)
+#define STORAGE_TASK_PRIO      (0)
 #endif
 
 extern RTOS_TASK_HANDLE menusTaskId;
@@ -61,6 +68,13 @@ extern RTOS_TASK_HANDLE cliTaskId;
 extern RTOS_DEFINE_STACK(cliStack, CLI_STACK_SIZE);
 #endif
 
+#if defined(STORAGE_TASK)
+extern RTOS_MUTEX_HANDLE storageMutex;
+extern RTOS_FLAG_HANDLE storageFlag;
+extern RTOS_TASK_HANDLE storageTaskId;
+extern RTOS_DEFINE_STACK(storageStack, STORAGE_STACK_SIZE);
+#endif
+
 void stackPaint();
 void tasksStart();
 
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "gtests.h"
+#include "location.h"
+
+#if defined(SDCARD) && defined(PCBFRSKY)
+
+static const char * const modelAudioFiles[] = {
+  "Land-on.wav",
+  "L1-on.wav",
+  "SA-up.wav",
+  "sb-DOWN.WAV",
+  "L2-off.wav",
+  "other.wav",
+};
+
+class ModelAudioFilesTest : public OpenTxTest
+{
+  protected:
+    char path[AUDIO_FILENAME_MAXLEN+1];
+    char * filename;
+
+    void SetUp() override
+    {
+      OpenTxTest::SetUp();
+      simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+
+      // SOUNDS_PATH/<lang>/<model name>
+      char * str = getAudioPath(path);
+      *(str - 1) = '\0';
+      sdCheckAndCreateDirectory(ROOT_PATH "SOUNDS");
+      sdCheckAndCreateDirectory(path);
+      *(str - 1) = '/';
+      str = strcat_currentmodelname(str, 0);
+      *str = '\0';
+      sdCheckAndCreateDirectory(path);
+      *str++ = '/';
+      filename = str;
+
+      for (auto name: modelAudioFiles) {
+        FIL file;
+        strcpy(filename, name);
+        ASSERT_EQ(FR_OK, f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE));
+        f_close(&file);
+      }
+    }
+
+    void TearDown() override
+    {
+      for (auto name: modelAudioFiles) {
+        strcpy(filename, name);
+        f_unlink(path);
+      }
+      *(filename - 1) = '\0';
+      f_unlink(path);
+      simuFatfsSetPaths("", "");
+    }
+
+    bool referenced(uint8_t category, uint8_t index, event_t event = 0)
+    {
+      char file[AUDIO_FILENAME_MAXLEN+1];
+      return isAudioFileReferenced((category << 24) + (index << 16) + event, file);
+    }
+};
+
+TEST_F(ModelAudioFilesTest, referenceModelAudioFiles)
+{
+  strcpy(g_model.flightModeData[1].name, "Land");
+  // also the name of a logical switch file
+  strcpy(g_model.flightModeData[2].name, "L1");
+  referenceModelAudioFiles();
+
+  EXPECT_TRUE(referenced(PHASE_AUDIO_CATEGORY, 1, AUDIO_EVENT_ON));
+  EXPECT_FALSE(referenced(PHASE_AUDIO_CATEGORY, 1, AUDIO_EVENT_OFF));
+  EXPECT_TRUE(referenced(PHASE_AUDIO_CATEGORY, 2, AUDIO_EVENT_ON));
+  EXPECT_FALSE(referenced(PHASE_AUDIO_CATEGORY, 0, AUDIO_EVENT_ON));
+
+  EXPECT_TRUE(referenced(SWITCH_AUDIO_CATEGORY, SWSRC_SA0 - SWSRC_FIRST_SWITCH));
+  EXPECT_FALSE(referenced(SWITCH_AUDIO_CATEGORY, SWSRC_SA1 - SWSRC_FIRST_SWITCH));
+  EXPECT_TRUE(referenced(SWITCH_AUDIO_CATEGORY, SWSRC_SB2 - SWSRC_FIRST_SWITCH));
+
+  // the flight mode takes precedence
+  EXPECT_FALSE(referenced(LOGICAL_SWITCH_AUDIO_CATEGORY, 0, AUDIO_EVENT_ON));
+  EXPECT_TRUE(referenced(LOGICAL_SWITCH_AUDIO_CATEGORY, 1, AUDIO_EVENT_OFF));
+  EXPECT_FALSE(referenced(LOGICAL_SWITCH_AUDIO_CATEGORY, 1, AUDIO_EVENT_ON));
+}
+
+#endif
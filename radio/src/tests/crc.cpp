@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <chrono>
+#include "gtests.h"
+#include "crc.h"
+
+// Bytewise reference implementations, as used before slicing
+static uint16_t crc16Ref(const unsigned short * tab, const uint8_t * buf, uint32_t len, uint16_t start)
+{
+  uint16_t crc = start;
+  for (uint32_t i=0; i<len; i++) {
+    crc = (crc<<8) ^ tab[((crc>>8) ^ *buf++) & 0x00FF];
+  }
+  return crc;
+}
+
+static uint8_t crc8Ref(uint8_t poly, const uint8_t * buf, uint32_t len)
+{
+  uint8_t crc = 0;
+  for (uint32_t i=0; i<len; i++) {
+    crc ^= *buf++;
+    for (uint8_t bit=0; bit<8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ poly : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+TEST(Crc, crc16)
+{
+  uint8_t buf[1024];
+  for (unsigned i=0; i<sizeof(buf); i++) {
+    buf[i] = i * 7 + (i >> 3);
+  }
+
+  for (uint32_t len=0; len<=64; len++) {
+    EXPECT_EQ(crc16Ref(crc16tab_1021, buf, len, 0), crc16(CRC_1021, buf, len));
+    EXPECT_EQ(crc16Ref(crc16tab_1189, buf + 1, len, 0x1234), crc16(CRC_1189, buf + 1, len, 0x1234));
+  }
+
+  // firmware update chunk
+  EXPECT_EQ(crc16Ref(crc16tab_1189, buf, sizeof(buf), 0), crc16(CRC_1189, buf, sizeof(buf)));
+}
+
+TEST(Crc, crc8)
+{
+  uint8_t buf[1024];
+  for (unsigned i=0; i<sizeof(buf); i++) {
+    buf[i] = i * 13 + (i >> 2);
+  }
+
+  for (uint32_t len=0; len<=64; len++) {
+    EXPECT_EQ(crc8Ref(0xD5, buf, len), crc8(buf, len));
+    EXPECT_EQ(crc8Ref(0xBA, buf + 3, len), crc8_BA(buf + 3, len));
+  }
+
+  EXPECT_EQ(crc8Ref(0xD5, buf, sizeof(buf)), crc8(buf, sizeof(buf)));
+  EXPECT_EQ(crc8Ref(0xBA, buf, sizeof(buf)), crc8_BA(buf, sizeof(buf)));
+}
+
+#if defined(CRC_SLICING)
+static uint8_t crc8tabRef[256];
+
+// Bytewise CRC8, as used before slicing
+static uint8_t crc8Bytewise(const uint8_t * buf, uint32_t len)
+{
+  uint8_t crc = 0;
+  for (uint32_t i=0; i<len; i++) {
+    crc = crc8tabRef[crc ^ *buf++];
+  }
+  return crc;
+}
+
+// Best time over a few runs, in ns per KB
+template <class F>
+static int crcNsPerKB(const uint8_t * buf, uint32_t len, F crc)
+{
+  const int rounds = 1000;
+  volatile uint32_t sink = 0;
+  double best = 0;
+  for (int run=0; run<5; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i=0; i<rounds; i++) {
+      sink = sink + crc(buf, len);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+  return best * 1024 / len / rounds;
+}
+
+// Throughput of the sliced and bytewise CRCs, reported as test
+// properties only (host timings say little about the radio)
+TEST(Crc, throughput)
+{
+  uint8_t buf[1024];
+  for (unsigned i=0; i<sizeof(buf); i++) {
+    buf[i] = i * 7 + (i >> 3);
+  }
+
+  for (unsigned i=0; i<256; i++) {
+    uint8_t byte = i;
+    crc8tabRef[i] = crc8Ref(0xD5, &byte, 1);
+  }
+  ASSERT_EQ(crc8(buf, sizeof(buf)), crc8Bytewise(buf, sizeof(buf)));
+
+  RecordProperty("crc16_bytewise_ns_per_kb", crcNsPerKB(buf, sizeof(buf), [](const uint8_t * p, uint32_t len) {
+    return crc16Ref(crc16tab_1189, p, len, 0);
+  }));
+  RecordProperty("crc16_sliced_ns_per_kb", crcNsPerKB(buf, sizeof(buf), [](const uint8_t * p, uint32_t len) {
+    return crc16(CRC_1189, p, len);
+  }));
+  RecordProperty("crc8_bytewise_ns_per_kb", crcNsPerKB(buf, sizeof(buf), crc8Bytewise));
+  RecordProperty("crc8_sliced_ns_per_kb", crcNsPerKB(buf, sizeof(buf), crc8));
+}
+#endif
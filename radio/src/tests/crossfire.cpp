@@ -28,14 +28,79 @@ TEST(Crossfire, createCrossfireChannelsFrame)
   int16_t pulsesStart[MAX_TRAINER_CHANNELS];
   uint8_t crossfire[CROSSFIRE_FRAME_MAXLEN];
 
+  MODEL_RESET();
   memset(crossfire, 0, sizeof(crossfire));
   for (int i=0; i<MAX_TRAINER_CHANNELS; i++) {
     pulsesStart[i] = -1024 + (2048 / MAX_TRAINER_CHANNELS) * i;
   }
 
-  createCrossfireChannelsFrame(crossfire, pulsesStart);
+  EXPECT_EQ(26, createCrossfireChannelsFrame(crossfire, pulsesStart));
+  EXPECT_EQ(24, crossfire[1]);
+  EXPECT_EQ(crc8(&crossfire[2], 23), crossfire[25]);
 
-  // TODO check
+  // unpack the 11 bits channels, LSB first
+  uint32_t bits = 0;
+  uint8_t bitsavailable = 0;
+  uint8_t * buf = &crossfire[3];
+  for (int i=0; i<MAX_TRAINER_CHANNELS; i++) {
+    while (bitsavailable < 11) {
+      bits |= *buf++ << bitsavailable;
+      bitsavailable += 8;
+    }
+    EXPECT_EQ(0x3E0 + (pulsesStart[i] * 4) / 5, int(bits & 0x7FF));
+    bits >>= 11;
+    bitsavailable -= 11;
+  }
+}
+
+// Channels frame as built before packChannels11Bits()
+static uint8_t legacyCrossfireChannelsFrame(uint8_t * frame, int16_t * pulses)
+{
+  uint8_t * buf = frame;
+  *buf++ = MODULE_ADDRESS;
+  *buf++ = 24;
+  uint8_t * crc_start = buf;
+  *buf++ = CHANNELS_ID;
+  uint32_t bits = 0;
+  uint8_t bitsavailable = 0;
+  for (int i=0; i<CROSSFIRE_CHANNELS_COUNT; i++) {
+#if defined(PPM_CENTER_ADJUSTABLE)
+    int offset = (2 * limitAddress(i)->ppmCenter) + 1;
+#else
+    int offset = 0;
+#endif
+    uint32_t val = limit(0, 0x3E0 + (offset * 4) / 5 + (pulses[i] * 4) / 5, 2 * 0x3E0);
+    bits |= val << bitsavailable;
+    bitsavailable += 11;
+    while (bitsavailable >= 8) {
+      *buf++ = bits;
+      bits >>= 8;
+      bitsavailable -= 8;
+    }
+  }
+  *buf++ = crc8(crc_start, 23);
+  return buf - frame;
+}
+
+TEST(Crossfire, channelsFrameMatchesLegacyEncoder)
+{
+  const int16_t outputs[] = {-2048, -1536, -1025, -1024, -1023, -1, 0, 1, 1023, 1024, 1025, 1536, 2047};
+  const int16_t centers[] = {-512, -1, 0, 1, 511};
+  int16_t pulses[CROSSFIRE_CHANNELS_COUNT];
+
+  MODEL_RESET();
+  for (unsigned pass=0; pass<DIM(outputs)*DIM(centers); pass++) {
+    for (int i=0; i<CROSSFIRE_CHANNELS_COUNT; i++) {
+      pulses[i] = outputs[(i + pass) % DIM(outputs)];
+      g_model.limitData[i].ppmCenter = centers[(i + pass / DIM(outputs)) % DIM(centers)];
+    }
+
+    uint8_t expected[CROSSFIRE_FRAME_MAXLEN];
+    uint8_t crossfire[CROSSFIRE_FRAME_MAXLEN];
+    ASSERT_EQ(26, legacyCrossfireChannelsFrame(expected, pulses));
+    ASSERT_EQ(26, createCrossfireChannelsFrame(crossfire, pulses));
+    ASSERT_EQ(0, memcmp(expected, crossfire, 26)) << "pass " << pass;
+  }
 }
 
 TEST(Crossfire, crc8)
@@ -38,11 +38,125 @@ extern Backup::RamBackupUncompressed ramBackupUncompressed;
 TEST(Storage, BackupAndRestore)
 {
   rambackupWrite();
-  Backup::RamBackupUncompressed ramBackupRestored;
-  if (uncompress((uint8_t *)&ramBackupRestored, sizeof(ramBackupRestored), ramBackup->data, ramBackup->size) != sizeof(ramBackupUncompressed))
-    TRACE("ERROR uncompress");
-  if (memcmp(&ramBackupUncompressed, &ramBackupRestored, sizeof(ramBackupUncompressed)) != 0)
-    TRACE("ERROR restore");
+  static Backup::RamBackupUncompressed ramBackupWritten;
+  memcpy(&ramBackupWritten, &ramBackupUncompressed, sizeof(ramBackupWritten));
+  memclear(&ramBackupUncompressed, sizeof(ramBackupUncompressed));
+  EXPECT_TRUE(rambackupRestore());
+  EXPECT_EQ(0, memcmp(&ramBackupUncompressed, &ramBackupWritten, sizeof(ramBackupWritten)));
+}
+
+TEST(Storage, BackupPowerCut)
+{
+  static Backup::RamBackupUncompressed previous;
+  static Backup::RamBackupUncompressed next;
+  static RamBackup backup;
+
+  MODEL_RESET();
+  memclear(ramBackup, sizeof(RamBackup));
+  rambackupWrite();
+  ASSERT_TRUE(rambackupRestore());
+  memcpy(&previous, &ramBackupUncompressed, sizeof(previous));
+
+  // nothing changed, only the table is written
+  rambackupPowerCut = INT32_MAX;
+  rambackupWrite();
+  EXPECT_EQ(int32_t(sizeof(RamBackupTable)), INT32_MAX - rambackupPowerCut);
+
+  // a single trim change only writes its page and the table
+  g_model.flightModeData[0].trim[0].value = 10;
+  rambackupPowerCut = INT32_MAX;
+  rambackupWrite();
+  EXPECT_LE(INT32_MAX - rambackupPowerCut,
+            int32_t(RAMBACKUP_PAGE_SIZE + RAMBACKUP_PAGE_SIZE / 32 + sizeof(RamBackupTable)));
+  rambackupPowerCut = -1;
+  memcpy(&previous, &ramBackupUncompressed, sizeof(previous));
+
+  int restoredPrevious = 0;
+  int restoredNext = 0;
+
+  for (int i = 0; i < 1000; i++) {
+    // a few trims and timers changes
+    for (int j = rand() % 3; j >= 0; j--) {
+      g_model.flightModeData[rand() % MAX_FLIGHT_MODES].trim[rand() % NUM_TRIMS].value = rand() % 200 - 100;
+      g_model.timers[rand() % MAX_TIMERS].start = rand() % 3600;
+    }
+
+    // complete write, to know the new image and how much is written
+    memcpy(&backup, ramBackup, sizeof(backup));
+    rambackupPowerCut = INT32_MAX;
+    rambackupWrite();
+    int32_t written = INT32_MAX - rambackupPowerCut;
+    memcpy(&next, &ramBackupUncompressed, sizeof(next));
+    memcpy(ramBackup, &backup, sizeof(backup));
+
+    // same write again, with a power cut somewhere
+    rambackupPowerCut = rand() % (written + 1);
+    rambackupWrite();
+    rambackupPowerCut = -1;
+
+    memclear(&ramBackupUncompressed, sizeof(ramBackupUncompressed));
+    ASSERT_TRUE(rambackupRestore());
+
+    if (!memcmp(&ramBackupUncompressed, &next, sizeof(next))) {
+      memcpy(&previous, &next, sizeof(previous));
+      restoredNext++;
+    }
+    else {
+      ASSERT_EQ(0, memcmp(&ramBackupUncompressed, &previous, sizeof(previous)));
+      restoredPrevious++;
+    }
+  }
+
+  EXPECT_GT(restoredPrevious, 0);
+  EXPECT_GT(restoredNext, 0);
+
+  // more and more of the model does not compress, until the changed pages
+  // do not fit next to the last backup, then until both backups do not fit
+  static ModelData model;
+  uint8_t * bytes = (uint8_t *)&g_model;
+  int kept = 0;
+  int dropped = 0;
+
+  for (unsigned int i = 0; i < sizeof(g_model) / 4; i++) {
+    for (unsigned int j = 0; j < 4; j++) {
+      bytes[(i * 4 + j * 1237) % sizeof(g_model)] = rand();
+    }
+    memcpy(&model, &g_model, sizeof(model));
+
+    memcpy(&backup, ramBackup, sizeof(backup));
+    rambackupPowerCut = INT32_MAX;
+    rambackupWrite();
+    int32_t written = INT32_MAX - rambackupPowerCut;
+    memcpy(&next, &ramBackupUncompressed, sizeof(next));
+    // the last backup is only dropped when both do not fit
+    bool keep = ramBackup->tables[0].sequence && ramBackup->tables[1].sequence;
+    memcpy(ramBackup, &backup, sizeof(backup));
+
+    rambackupPowerCut = rand() % (written + 1);
+    rambackupWrite();
+    rambackupPowerCut = -1;
+
+    memclear(&ramBackupUncompressed, sizeof(ramBackupUncompressed));
+    if (rambackupRestore()) {
+      if (memcmp(&ramBackupUncompressed, &next, sizeof(next)))
+        ASSERT_EQ(0, memcmp(&ramBackupUncompressed, &previous, sizeof(previous)));
+    }
+    else {
+      ASSERT_FALSE(keep);
+    }
+    keep ? kept++ : dropped++;
+
+    // complete write, the image may not even fit alone any more
+    memcpy(&g_model, &model, sizeof(g_model));
+    rambackupWrite();
+    memcpy(&previous, &ramBackupUncompressed, sizeof(previous));
+    if (!rambackupRestore())
+      break;
+  }
+
+  EXPECT_GT(kept, 0);
+  EXPECT_GT(dropped, 0);
+  MODEL_RESET();
 }
 #endif
 
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "fifo.h"
+#include "serial_tx_fifo.h"
+
+TEST(Fifo, bulkPushPop)
+{
+  Fifo<uint8_t, 16> fifo;
+  uint8_t data[32];
+  uint8_t result[32];
+
+  for (unsigned i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+
+  // a fifo of size N holds N-1 elements
+  EXPECT_EQ(15u, fifo.push(data, 20));
+  EXPECT_TRUE(fifo.isFull());
+  EXPECT_EQ(0u, fifo.push(data, 1));
+
+  EXPECT_EQ(10u, fifo.pop(result, 10));
+  for (unsigned i = 0; i < 10; i++) {
+    EXPECT_EQ(i, result[i]);
+  }
+
+  // wraps around the end of the buffer
+  EXPECT_EQ(10u, fifo.push(data + 15, 10));
+  EXPECT_EQ(15u, fifo.size());
+  EXPECT_EQ(15u, fifo.pop(result, sizeof(result)));
+  for (unsigned i = 0; i < 15; i++) {
+    EXPECT_EQ(i + 10, result[i]);
+  }
+  EXPECT_TRUE(fifo.isEmpty());
+  EXPECT_EQ(0u, fifo.pop(result, sizeof(result)));
+}
+
+TEST(Fifo, bulkMatchesSingle)
+{
+  Fifo<uint8_t, 64> single;
+  Fifo<uint8_t, 64> bulk;
+  uint8_t stream[256];
+  uint8_t chunk[13];
+
+  for (unsigned i = 0; i < sizeof(stream); i++) {
+    stream[i] = i * 31 + 7;
+  }
+
+  // synthetic byte stream in chunks of varying size
+  unsigned written = 0, read = 0;
+  for (unsigned n = 1; read < sizeof(stream); n = (n % 13) + 1) {
+    unsigned len = n < sizeof(stream) - written ? n : sizeof(stream) - written;
+    for (unsigned i = 0; i < len; i++) {
+      single.push(stream[written + i]);
+    }
+    EXPECT_EQ(len, bulk.push(stream + written, len));
+    written += len;
+
+    uint32_t count = bulk.pop(chunk, n);
+    for (unsigned i = 0; i < count; i++) {
+      uint8_t byte = 0;
+      EXPECT_TRUE(single.pop(byte));
+      EXPECT_EQ(stream[read + i], chunk[i]);
+      EXPECT_EQ(byte, chunk[i]);
+    }
+    read += count;
+    EXPECT_EQ(single.size(), bulk.size());
+  }
+}
+
+TEST(SerialTxFifo, backPressure)
+{
+  SerialTxFifo<16> fifo;
+  uint8_t data[16] = {0};
+
+  // whole buffers only, the sender is never blocked
+  EXPECT_TRUE(fifo.write(data, 10));
+  EXPECT_FALSE(fifo.write(data, 6));
+  EXPECT_TRUE(fifo.write(data, 5));
+  EXPECT_FALSE(fifo.write(data, 1));
+
+  // bytes being transmitted keep their room until the transfer is done
+  const uint8_t * chunk;
+  uint32_t len;
+  EXPECT_TRUE(fifo.nextChunk(chunk, len));
+  EXPECT_EQ(15u, len);
+  EXPECT_FALSE(fifo.write(data, 1));
+  EXPECT_FALSE(fifo.nextChunk(chunk, len));
+  EXPECT_TRUE(fifo.isBusy());
+
+  fifo.chunkDone();
+  EXPECT_FALSE(fifo.isBusy());
+  EXPECT_TRUE(fifo.write(data, 15));
+}
+
+TEST(SerialTxFifo, chainedTransfers)
+{
+  SerialTxFifo<64> fifo;
+  uint8_t frame[24];
+  uint8_t sent[512];
+  unsigned written = 0, received = 0;
+
+  // frames are queued while the previous ones are being transmitted,
+  // the transfers are chained in contiguous chunks, in order
+  for (unsigned n = 0; n < 20; n++) {
+    for (unsigned i = 0; i < sizeof(frame); i++) {
+      frame[i] = written + i;
+    }
+    if (fifo.write(frame, sizeof(frame))) {
+      written += sizeof(frame);
+    }
+
+    const uint8_t * chunk;
+    uint32_t len;
+    if (n & 1) {
+      // transfer completed
+      fifo.chunkDone();
+    }
+    if (fifo.nextChunk(chunk, len)) {
+      EXPECT_LE(len, 64u);
+      memcpy(sent + received, chunk, len);
+      received += len;
+    }
+  }
+
+  // drain
+  const uint8_t * chunk;
+  uint32_t len;
+  do {
+    fifo.chunkDone();
+    if (fifo.nextChunk(chunk, len)) {
+      memcpy(sent + received, chunk, len);
+      received += len;
+    }
+  } while (fifo.isBusy());
+
+  EXPECT_EQ(written, received);
+  EXPECT_LT(sizeof(frame), written);
+  for (unsigned i = 0; i < received; i++) {
+    EXPECT_EQ(uint8_t(i), sent[i]);
+  }
+}
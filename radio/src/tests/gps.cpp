@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "gtests.h"
+
+#if defined(INTERNAL_GPS)
+static void gpsFeed(const char * data)
+{
+  while (*data) {
+    gpsNewData(*data++);
+  }
+}
+
+static void gpsFeed(const uint8_t * data, uint32_t len)
+{
+  while (len--) {
+    gpsNewData(*data++);
+  }
+}
+
+static void gpsReset()
+{
+  gpsFeed("\r\n");
+  memclear(&gpsData, sizeof(gpsData));
+}
+
+// u-blox M8N output, 5 sentences configured
+static const char nmeaLog[] =
+    "$GNRMC,092725.00,A,4717.11399,N,00833.91590,E,10.5,77.52,091202,,,A*7A\r\n"
+    "$GNVTG,77.52,T,,M,10.5,N,19.4,K,A*1C\r\n"
+    "$GNGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*45\r\n"
+    "$GNGSA,A,3,21,05,29,25,12,10,26,02,,,,,1.88,1.01,1.59*1E\r\n"
+    "$GPGSV,3,1,10,23,38,230,44,29,71,156,47,07,29,116,41,08,09,081,36*7F\r\n"
+    "$GLGSV,1,1,02,65,43,069,28,72,28,302,33*68\r\n"
+    "$GNGLL,4717.11399,N,00833.91590,E,092725.00,A,A*76\r\n";
+
+TEST(Gps, nmeaLog)
+{
+  gpsReset();
+  gpsFeed(nmeaLog);
+
+  EXPECT_EQ(7u, gpsData.packetCount);
+  EXPECT_EQ(0u, gpsData.errorCount);
+  EXPECT_EQ(1, gpsData.fix);
+  EXPECT_EQ(8, gpsData.numSat);
+  EXPECT_EQ(101, gpsData.hdop);
+  EXPECT_EQ(47285231, gpsData.latitude);
+  EXPECT_EQ(8565265, gpsData.longitude);
+  EXPECT_EQ(499, gpsData.altitude);
+  EXPECT_EQ(540, gpsData.speed);
+  EXPECT_EQ(775, gpsData.groundCourse);
+}
+
+TEST(Gps, nmeaSouthWestAndFixLost)
+{
+  gpsReset();
+  gpsFeed("$GPGGA,101010.00,3348.12345,S,15112.54321,W,1,05,2.5,12.0,M,48.0,M,,*55\r\n");
+
+  EXPECT_EQ(1, gpsData.fix);
+  EXPECT_EQ(250, gpsData.hdop);
+  EXPECT_EQ(-33802056, gpsData.latitude);
+  EXPECT_EQ(-151209053, gpsData.longitude);
+
+  // no fix, the last position is kept
+  gpsFeed("$GPGGA,092726.00,3348.12345,S,15112.54321,W,0,00,99.99,12.0,M,48.0,M,,*5F\r\n");
+  EXPECT_EQ(0, gpsData.fix);
+  EXPECT_EQ(0, gpsData.numSat);
+  EXPECT_EQ(9999, gpsData.hdop);
+  EXPECT_EQ(-33802056, gpsData.latitude);
+}
+
+TEST(Gps, nmeaGarbage)
+{
+  gpsReset();
+
+  // bad checksum
+  gpsFeed("$GNGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*46\r\n");
+  EXPECT_EQ(1u, gpsData.errorCount);
+  EXPECT_EQ(0, gpsData.fix);
+
+  // truncated sentence, restarted by the next '$', then noise and an overlong line
+  gpsFeed("$GNGGA,092725.00,4717.1");
+  gpsFeed("\x01\xFF noise $$$");
+  gpsFeed("$GNGSA,A,3,21,05,29,25,12,10,26,02,,,,,1.88,1.01,1.59,1.88,1.01,1.59,1.88,1.01,1.59*1E\r\n");
+  gpsFeed(nmeaLog);
+
+  EXPECT_EQ(7u, gpsData.packetCount);
+  EXPECT_EQ(1u, gpsData.errorCount);
+  EXPECT_EQ(47285231, gpsData.latitude);
+}
+
+static void ubxPut32(uint8_t * p, int32_t value)
+{
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+}
+
+static uint32_t ubxBuildNavPvt(uint8_t * frame)
+{
+  uint8_t * payload = &frame[6];
+  memclear(payload, 92);
+
+  payload[4] = 2022 & 0xFF;   // year
+  payload[5] = 2022 >> 8;
+  payload[6] = 10;            // month
+  payload[7] = 18;            // day
+  payload[11] = 0x03;         // valid date and time
+  payload[20] = 3;            // 3D fix
+  payload[21] = 0x01;         // gnssFixOK
+  payload[23] = 14;           // numSV
+  ubxPut32(&payload[24], 85652651);    // lon
+  ubxPut32(&payload[28], -472852319);  // lat
+  ubxPut32(&payload[36], 499612);      // hMSL
+  ubxPut32(&payload[60], 5402);        // gSpeed
+  ubxPut32(&payload[64], 7752000);     // headMot
+  payload[76] = 87;                    // pDOP
+
+  frame[0] = 0xB5;
+  frame[1] = 0x62;
+  frame[2] = 0x01;  // NAV
+  frame[3] = 0x07;  // PVT
+  frame[4] = 92;
+  frame[5] = 0;
+
+  uint8_t ckA = 0, ckB = 0;
+  for (int i = 2; i < 6 + 92; i++) {
+    ckA += frame[i];
+    ckB += ckA;
+  }
+  frame[6 + 92] = ckA;
+  frame[6 + 92 + 1] = ckB;
+
+  return 6 + 92 + 2;
+}
+
+TEST(Gps, ubxNavPvt)
+{
+  gpsReset();
+
+  uint8_t frame[100];
+  uint32_t len = ubxBuildNavPvt(frame);
+
+  // UBX between NMEA sentences
+  gpsFeed("$GNGLL,4717.11399,N,00833.91590,E,092725.00,A,A*76\r\n");
+  gpsFeed(frame, len);
+  gpsFeed("$GLGSV,1,1,02,65,43,069,28,72,28,302,33*68\r\n");
+
+  EXPECT_EQ(3u, gpsData.packetCount);
+  EXPECT_EQ(0u, gpsData.errorCount);
+  EXPECT_EQ(1, gpsData.fix);
+  EXPECT_EQ(14, gpsData.numSat);
+  EXPECT_EQ(87, gpsData.hdop);
+  EXPECT_EQ(-47285231, gpsData.latitude);
+  EXPECT_EQ(8565265, gpsData.longitude);
+  EXPECT_EQ(499, gpsData.altitude);
+  EXPECT_EQ(540, gpsData.speed);
+  EXPECT_EQ(775, gpsData.groundCourse);
+
+  // corrupted payload
+  frame[30] ^= 0x40;
+  gpsFeed(frame, len);
+  EXPECT_EQ(1u, gpsData.errorCount);
+  EXPECT_EQ(-47285231, gpsData.latitude);
+
+  // a stray sync byte does not swallow the sentence which follows
+  gpsFeed("\xB5$GNGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*45\r\n");
+  EXPECT_EQ(4u, gpsData.packetCount);
+  EXPECT_EQ(47285231, gpsData.latitude);
+
+  // a header with an oversized length is dropped, the frame which
+  // follows is decoded
+  frame[30] ^= 0x40;
+  static const uint8_t oversized[] = { 0xB5, 0x62, 0x01, 0x07, 0xFF, 0xFF };
+  gpsFeed(oversized, sizeof(oversized));
+  gpsFeed(frame, len);
+  EXPECT_EQ(5u, gpsData.packetCount);
+  EXPECT_EQ(1u, gpsData.errorCount);
+  EXPECT_EQ(-47285231, gpsData.latitude);
+}
+#endif
@@ -29,6 +29,7 @@
 #if defined(COLORLCD)
 
 #include "gui/colorlcd/fonts.h"
+#include "targets/simu/simulcd.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
@@ -228,6 +229,58 @@ TEST(Lcd_colorlcd, fonts)
 }
 #endif
 
+TEST(Lcd_colorlcd, textWidth)
+{
+  for (int font = 0; font < FONTS_COUNT; font++) {
+    const uint16_t * specs = fontspecsTable[font];
+    const LcdFlags flags = LcdFlags(font) << 8u; // same as FONT(xx)
+    for (unsigned c = 0x20; c < 0xFE && c < fontCharactersTable[font] + 0x20u; c++) {
+      int width = specs[c - 0x20 + 2] - specs[c - 0x20 + 1];
+      char str[] = { char(c), char(c), '\0' };
+      EXPECT_EQ(width, getTextWidth(str, 1, flags));
+      EXPECT_EQ(2 * width, getTextWidth(str, 0, flags));
+    }
+  }
+
+  // control characters have no width
+  EXPECT_EQ(0, getTextWidth("\x01\x02", 0, FONT(STD)));
+}
+
+TEST(Lcd_colorlcd, lazyFonts)
+{
+  const tmr10ms_t savedTime = g_tmr10ms;
+  loadFonts();
+  unloadUnusedFonts(0);
+
+  // only the STD font stays, the others point to it
+  EXPECT_TRUE(isFontLoaded(FONT_INDEX(FONT(STD))));
+  for (unsigned font = 1; font < FONTS_COUNT; font++) {
+    EXPECT_FALSE(isFontLoaded(font));
+    EXPECT_EQ(fontsTable[0], fontsTable[font]);
+  }
+
+  // decompressed on first use only
+  BitmapBuffer dc(BMP_RGB565, LCD_W, LCD_H);
+  dc.drawText(0, 0, "XXL", FONT(XXL));
+  EXPECT_TRUE(isFontLoaded(FONT_INDEX(FONT(XXL))));
+  EXPECT_NE(fontsTable[0], fontsTable[FONT_INDEX(FONT(XXL))]);
+  EXPECT_FALSE(isFontLoaded(FONT_INDEX(FONT(L))));
+
+  // kept while in use
+  EXPECT_EQ(0u, unloadUnusedFonts(FONT_UNLOAD_DELAY));
+  EXPECT_TRUE(isFontLoaded(FONT_INDEX(FONT(XXL))));
+
+  // freed when unused, decompressed again on the next use
+  g_tmr10ms += FONT_UNLOAD_DELAY;
+  EXPECT_EQ(1u, unloadUnusedFonts(FONT_UNLOAD_DELAY));
+  EXPECT_FALSE(isFontLoaded(FONT_INDEX(FONT(XXL))));
+  EXPECT_EQ(fontsTable[0], fontsTable[FONT_INDEX(FONT(XXL))]);
+  dc.drawText(0, 0, "XXL", FONT(XXL));
+  EXPECT_TRUE(isFontLoaded(FONT_INDEX(FONT(XXL))));
+
+  g_tmr10ms = savedTime;
+}
+
 TEST(Lcd_colorlcd, clipping)
 {
   loadFonts();
@@ -271,6 +324,36 @@ TEST(Lcd_colorlcd, bitmap)
   EXPECT_TRUE(checkScreenshot_colorlcd(&dc, "bitmap"));
 }
 
+TEST(Lcd_colorlcd, bitmap_batched)
+{
+  // queued DMA operations must give the same result
+  BitmapBuffer dc(BMP_RGB565, LCD_W, LCD_H);
+  std::unique_ptr<BitmapBuffer> bmp(BitmapBuffer::loadBitmap(TESTS_PATH "/opentx.png"));
+
+  dc.clear(COLOR2FLAGS(BLACK));
+  pixel_t black = *dc.getPixelPtr(0, 0);
+
+  DMABatchBegin();
+  dc.clear(COLOR_THEME_SECONDARY3);
+  // not drawn until the fence
+  EXPECT_EQ(1, DMAPendingOperations());
+  EXPECT_EQ(black, *dc.getPixelPtr(0, 0));
+  DMAWait();
+  EXPECT_EQ(0, DMAPendingOperations());
+  EXPECT_NE(black, *dc.getPixelPtr(0, 0));
+
+  dc.setClippingRect(100, 400, 50, 200);
+  dc.drawBitmap(  0,   0, bmp.get());
+  dc.drawBitmap(320,   0, bmp.get());
+  dc.drawBitmap(  0, 150, bmp.get());
+  EXPECT_LT(0, DMAPendingOperations());
+  DMABatchEnd();
+  EXPECT_EQ(0, DMAPendingOperations());
+
+  dc.clearClippingRect();
+  EXPECT_TRUE(checkScreenshot_colorlcd(&dc, "bitmap"));
+}
+
 TEST(Lcd_colorlcd, masks)
 {
   BitmapBuffer dc(BMP_RGB565, LCD_W, LCD_H);
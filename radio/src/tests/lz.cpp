@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include <chrono>
+#include <string>
+#include "gtests.h"
+#include "location.h"
+
+#if defined(RTC_BACKUP_RAM)
+#include "storage/lz.h"
+#include "storage/rlc.h"
+
+#define PAGE_SIZE 512
+
+typedef unsigned int (*codec_func)(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
+
+// compress page by page, the way the RTC backup does, check the data
+// decodes back to the original, and return the compressed size
+static unsigned int testCodec(codec_func encode, codec_func decode, const uint8_t * data, unsigned int len)
+{
+  unsigned int result = 0;
+  uint8_t compressed[PAGE_SIZE + PAGE_SIZE / 32];
+  uint8_t uncompressed[PAGE_SIZE];
+
+  for (unsigned int ofs = 0; ofs < len; ofs += PAGE_SIZE) {
+    unsigned int pageSize = min<unsigned int>(PAGE_SIZE, len - ofs);
+    unsigned int size = encode(compressed, sizeof(compressed), data + ofs, pageSize);
+
+    EXPECT_NE(0U, size);
+    EXPECT_EQ(pageSize, decode(uncompressed, pageSize, compressed, size));
+    EXPECT_EQ(0, memcmp(uncompressed, data + ofs, pageSize));
+    result += size;
+  }
+
+  return result;
+}
+
+// Best time over a few runs to compress the data page by page, in ns
+static int encodeTime(codec_func encode, const uint8_t * data, unsigned int len)
+{
+  uint8_t compressed[PAGE_SIZE + PAGE_SIZE / 32];
+  double best = 0;
+
+  for (int run = 0; run < 5; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; i++) {
+      for (unsigned int ofs = 0; ofs < len; ofs += PAGE_SIZE) {
+        encode(compressed, sizeof(compressed), data + ofs, min<unsigned int>(PAGE_SIZE, len - ofs));
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+
+  return best / 20;
+}
+
+// Sizes and compression times are recorded as test properties, the
+// times only compare the codecs (the tests are built without optimization)
+static void compareCodecs(const char * name, const uint8_t * data, unsigned int len)
+{
+  unsigned int rlc = testCodec(compress, uncompress, data, len);
+  unsigned int lz = testCodec(lzCompress, lzUncompress, data, len);
+  EXPECT_LE(lz, rlc) << name;
+
+  std::string key(name);
+  testing::Test::RecordProperty(key + "_rlc_bytes", rlc);
+  testing::Test::RecordProperty(key + "_lz_bytes", lz);
+  testing::Test::RecordProperty(key + "_rlc_ns", encodeTime(compress, data, len));
+  testing::Test::RecordProperty(key + "_lz_ns", encodeTime(lzCompress, data, len));
+}
+
+static void populateModel()
+{
+  MODEL_RESET();
+  setModelDefaults();
+
+  for (uint8_t i = 0; i < MAX_MIXERS; i++) {
+    MixData & mix = g_model.mixData[i];
+    mix.destCh = i % 16;
+    mix.srcRaw = MIXSRC_FIRST_STICK + (i % 4);
+    mix.weight = 100 - (i % 3) * 25;
+    mix.swtch = (i % 5) ? 0 : i / 5;
+    mix.speedUp = (i % 7) ? 0 : 10;
+  }
+
+  for (uint8_t i = 0; i < MAX_EXPOS; i++) {
+    ExpoData & expo = g_model.expoData[i];
+    expo.mode = 3;
+    expo.srcRaw = MIXSRC_FIRST_STICK + (i % 4);
+    expo.chn = i % 4;
+    expo.weight = 100;
+    expo.curve.type = CURVE_REF_EXPO;
+    expo.curve.value = 30;
+  }
+
+  for (uint8_t i = 0; i < MAX_LOGICAL_SWITCHES; i++) {
+    LogicalSwitchData & ls = g_model.logicalSw[i];
+    ls.func = LS_FUNC_VPOS;
+    ls.v1 = MIXSRC_FIRST_STICK + (i % 4);
+    ls.v2 = i * 10;
+  }
+
+  for (uint8_t i = 0; i < MAX_TELEMETRY_SENSORS; i++) {
+    TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    sensor.id = 0x0100 + i;
+    sensor.instance = i % 4;
+    sensor.type = TELEM_TYPE_CUSTOM;
+    sensor.unit = UNIT_VOLTS;
+    sensor.prec = 1;
+  }
+}
+
+TEST(Compression, LzAgainstRlc)
+{
+  MODEL_RESET();
+  setModelDefaults();
+  compareCodecs("default_model", (uint8_t *)&g_model, sizeof(g_model));
+
+  populateModel();
+  compareCodecs("populated_model", (uint8_t *)&g_model, sizeof(g_model));
+}
+
+#if defined(PCBX10) || defined(PCBX12S)
+static void compareCodecsOnFile(const char * name, const char * path)
+{
+  FILE * f = fopen(path, "rb");
+  ASSERT_TRUE(f != nullptr) << path;
+
+  static uint8_t data[sizeof(ModelData) + 1024];
+  unsigned int len = fread(data, 1, sizeof(data), f);
+  fclose(f);
+
+  compareCodecs(name, data, len);
+}
+
+// models saved from real radios, extracted for these targets only
+TEST(Compression, LzAgainstRlcOnModelFiles)
+{
+  compareCodecsOnFile("x10_model1", TESTS_BUILD_PATH "/model_23_x10/MODELS/model1.bin");
+  compareCodecsOnFile("tx16s_model1", TESTS_BUILD_PATH "/model_25_tx16s/MODELS/model1.bin");
+  compareCodecsOnFile("tx16s_model2", TESTS_BUILD_PATH "/model_25_tx16s/MODELS/model2.bin");
+}
+#endif
+
+TEST(Compression, LzIncompressible)
+{
+  uint8_t data[PAGE_SIZE];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = rand();
+  }
+  testCodec(lzCompress, lzUncompress, data, sizeof(data));
+}
+
+TEST(Compression, LzCorruptData)
+{
+  const uint8_t match[] = {0x80, 0x10};  // copy from before the start
+  uint8_t output[PAGE_SIZE];
+  EXPECT_EQ(0U, lzUncompress(output, sizeof(output), match, sizeof(match)));
+
+  const uint8_t literals[] = {0x10, 0x01};  // not enough literals
+  EXPECT_EQ(0U, lzUncompress(output, sizeof(output), literals, sizeof(literals)));
+
+  const uint8_t zeros[] = {0x7F};  // too much output
+  EXPECT_EQ(0U, lzUncompress(output, 16, zeros, sizeof(zeros)));
+}
+#endif
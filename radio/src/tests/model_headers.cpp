@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "model_slots.h"
+
+#if defined(SDCARD_YAML) && !defined(STORAGE_MODELSLIST)
+static void reloadModelHeaders()
+{
+  memclear(modelHeaders, sizeof(modelHeaders));
+  loadModelHeaders();
+}
+
+static bool readIndex(ModelHeadersIndexHeader * header, ModelHeadersIndexEntry * entries)
+{
+  FIL file;
+  if (f_open(&file, MODEL_HEADERS_INDEX_PATH, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    return false;
+
+  UINT read;
+  bool result = f_read(&file, header, sizeof(*header), &read) == FR_OK && read == sizeof(*header) &&
+                f_read(&file, entries, MAX_MODELS * sizeof(*entries), &read) == FR_OK &&
+                read == MAX_MODELS * sizeof(*entries);
+  f_close(&file);
+  return result;
+}
+
+static bool writeIndex(const ModelHeadersIndexHeader * header, const ModelHeadersIndexEntry * entries)
+{
+  FIL file;
+  if (f_open(&file, MODEL_HEADERS_INDEX_PATH, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    return false;
+
+  UINT written;
+  bool result = f_write(&file, header, sizeof(*header), &written) == FR_OK &&
+                f_write(&file, entries, MAX_MODELS * sizeof(*entries), &written) == FR_OK;
+  f_close(&file);
+  return result;
+}
+
+typedef ModelSlotsTest ModelHeadersIndexTest;
+
+TEST_F(ModelHeadersIndexTest, sixtyModels)
+{
+  char name[LEN_MODEL_NAME + 1];
+  for (uint8_t i = 0; i < MAX_MODELS; i++) {
+    sprintf(name, "Model %02d", i);
+    writeModelSlot(i, name);
+  }
+
+  // no index yet: every model file is parsed, and the index is written
+  reloadModelHeaders();
+
+  static ModelHeadersIndexHeader header;
+  static ModelHeadersIndexEntry entries[MAX_MODELS];
+  ASSERT_TRUE(readIndex(&header, entries));
+  EXPECT_EQ(0, memcmp(header.magic, "MHI", sizeof(header.magic)));
+  EXPECT_EQ(MODEL_HEADERS_INDEX_VERSION, header.version);
+  EXPECT_EQ(MAX_MODELS, header.entries);
+  EXPECT_EQ(sizeof(ModelHeadersIndexEntry), header.entrySize);
+  EXPECT_EQ(MODEL_HEADER_LAYOUT_HASH, header.layout);
+
+  for (uint8_t i = 0; i < MAX_MODELS; i++) {
+    sprintf(name, "Model %02d", i);
+    EXPECT_STRNEQ(name, modelHeaders[i].name);
+    EXPECT_STRNEQ(name, entries[i].header.name);
+
+    char model_idx[MODELIDX_STRLEN];
+    getModelNumberStr(i, model_idx);
+    GET_FILENAME(fname, MODELS_PATH, model_idx, YAML_EXT);
+    FILINFO fno;
+    ASSERT_EQ(FR_OK, f_stat(fname, &fno));
+    EXPECT_EQ(fno.fsize, entries[i].stamp.size);
+    EXPECT_EQ(fno.fdate, entries[i].stamp.date);
+    EXPECT_EQ(fno.ftime, entries[i].stamp.time);
+  }
+
+  // entries matching their file are taken from the index
+  strncpy(entries[7].header.name, "Indexed", sizeof(entries[7].header.name));
+  ASSERT_TRUE(writeIndex(&header, entries));
+  reloadModelHeaders();
+  EXPECT_STRNEQ("Indexed", modelHeaders[7].name);
+  EXPECT_STRNEQ("Model 08", modelHeaders[8].name);
+
+  // an index written with another header layout is ignored and rebuilt
+  header.layout ^= 1;
+  ASSERT_TRUE(writeIndex(&header, entries));
+  reloadModelHeaders();
+  EXPECT_STRNEQ("Model 07", modelHeaders[7].name);
+  ASSERT_TRUE(readIndex(&header, entries));
+  EXPECT_EQ(MODEL_HEADER_LAYOUT_HASH, header.layout);
+  EXPECT_STRNEQ("Model 07", entries[7].header.name);
+}
+
+TEST_F(ModelHeadersIndexTest, incrementalUpdates)
+{
+  writeModelSlot(0, "First");
+  writeModelSlot(1, "Second");
+  writeModelSlot(2, "Third");
+  reloadModelHeaders();
+
+  // saved from the radio: the entry is updated in place
+  writeModelSlot(1, "Renamed");
+  // deleted from the radio
+  deleteModel(2);
+  // changed behind the radio's back (size differs)
+  setModelName("Changed");
+  writeModelYaml("model00" YAML_EXT);
+
+  reloadModelHeaders();
+  EXPECT_STRNEQ("Changed", modelHeaders[0].name);
+  EXPECT_STRNEQ("Renamed", modelHeaders[1].name);
+  EXPECT_EQ(0, modelHeaders[2].name[0]);
+  EXPECT_EQ(0, modelHeaders[3].name[0]);
+}
+
+#endif
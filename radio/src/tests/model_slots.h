@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _MODEL_SLOTS_H_
+#define _MODEL_SLOTS_H_
+
+#include "gtests.h"
+#include "location.h"
+
+#if defined(SDCARD_YAML) && !defined(STORAGE_MODELSLIST)
+#include "storage/sdcard_yaml.h"
+
+inline void setModelName(const char * name)
+{
+  memclear(g_model.header.name, sizeof(g_model.header.name));
+  strncpy(g_model.header.name, name, sizeof(g_model.header.name));
+}
+
+// saves g_model with the given name into a model slot
+inline void writeModelSlot(uint8_t idx, const char * name)
+{
+  setModelName(name);
+  g_eeGeneral.currModel = idx;
+  EXPECT_EQ(nullptr, writeModel());
+}
+
+// model slots stored in the tests build directory,
+// all of them deleted after each test
+class ModelSlotsTest : public OpenTxTest
+{
+  protected:
+    void SetUp() override
+    {
+      OpenTxTest::SetUp();
+      simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+      sdCheckAndCreateDirectory(MODELS_PATH);
+      f_unlink(MODEL_HEADERS_INDEX_PATH);
+    }
+
+    void TearDown() override
+    {
+      for (uint8_t i = 0; i < MAX_MODELS; i++) {
+        deleteModel(i);
+      }
+      f_unlink(MODEL_HEADERS_INDEX_PATH);
+      memclear(modelHeaders, sizeof(modelHeaders));
+      simuFatfsSetPaths("", "");
+    }
+};
+#endif
+
+#endif // _MODEL_SLOTS_H_
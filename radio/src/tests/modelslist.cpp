@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "gtests.h"
+#include "location.h"
+
+#if defined(SDCARD_YAML) && defined(STORAGE_MODELSLIST)
+#include "storage/modelslist.h"
+
+class ModelsListTest : public OpenTxTest
+{
+  protected:
+    void SetUp() override
+    {
+      OpenTxTest::SetUp();
+      simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+      sdCheckAndCreateDirectory(MODELS_PATH);
+      modelslist.clear();
+    }
+
+    void TearDown() override
+    {
+      modelslist.clear();
+      f_unlink(MODELSLIST_YAML_PATH);
+      simuFatfsSetPaths("", "");
+    }
+};
+
+static void setXjtModelId(ModelData * model, uint8_t modelId)
+{
+  memclear(model, sizeof(ModelData));
+  model->moduleData[EXTERNAL_MODULE].type = MODULE_TYPE_XJT_PXX1;
+  model->header.modelId[EXTERNAL_MODULE] = modelId;
+}
+
+TEST_F(ModelsListTest, rfDataCached)
+{
+  static ModelData model;
+  auto cat = modelslist.createCategory("Models", false);
+
+  // none of these model files exist: the RF data
+  // can only come from the models list itself
+  for (uint8_t i = 1; i <= 3; i++) {
+    char filename[LEN_MODEL_FILENAME + 1];
+    sprintf(filename, "rfdata%d.yml", i);
+    auto cell = modelslist.addModel(cat, filename, false);
+    setXjtModelId(&model, i);
+    cell->setRfData(&model);
+  }
+  modelslist.save();
+  modelslist.clear();
+
+  strcpy(g_eeGeneral.currModelFilename, "rfdata1.yml");
+  setXjtModelId(&g_model, 1);
+  ASSERT_TRUE(modelslist.load());
+
+  auto cell = modelslist.getCurrentModel();
+  ASSERT_NE(nullptr, cell);
+  EXPECT_STREQ("rfdata1.yml", cell->modelFilename);
+
+  for (auto c : *modelslist.getCurrentCategory()) {
+    EXPECT_TRUE(c->valid_rfData);
+    EXPECT_EQ(MODULE_TYPE_XJT_PXX1, c->moduleData[EXTERNAL_MODULE].type);
+  }
+
+  char warn[64];
+  g_model.header.modelId[EXTERNAL_MODULE] = 2;
+  EXPECT_FALSE(modelslist.isModelIdUnique(EXTERNAL_MODULE, warn, sizeof(warn)));
+  EXPECT_STREQ("rfdata2", warn);
+
+  g_model.header.modelId[EXTERNAL_MODULE] = 5;
+  EXPECT_TRUE(modelslist.isModelIdUnique(EXTERNAL_MODULE, warn, sizeof(warn)));
+
+  EXPECT_EQ(1, modelslist.findNextUnusedModelId(EXTERNAL_MODULE));
+  g_model.moduleData[EXTERNAL_MODULE].type = MODULE_TYPE_NONE;
+  EXPECT_TRUE(modelslist.isModelIdUnique(EXTERNAL_MODULE, warn, sizeof(warn)));
+}
+
+TEST_F(ModelsListTest, rfDataUpdatedOnSave)
+{
+  strcpy(g_eeGeneral.currModelFilename, "rfdata1.yml");
+  auto cat = modelslist.createCategory("Models", false);
+  modelslist.setCurrentModel(modelslist.addModel(cat, "rfdata1.yml", false));
+  modelslist.save();
+
+  // the cell follows the written model, not g_model
+  static ModelData written;
+  setXjtModelId(&written, 7);
+  setXjtModelId(&g_model, 3);
+  modelslist.onCurrentModelSaved("rfdata1.yml", &written);
+
+  modelslist.clear();
+  ASSERT_TRUE(modelslist.load());
+  auto cell = modelslist.getCurrentModel();
+  ASSERT_NE(nullptr, cell);
+  EXPECT_TRUE(cell->valid_rfData);
+  EXPECT_EQ(7, cell->modelId[EXTERNAL_MODULE]);
+}
+#endif
@@ -0,0 +1,629 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "pulses/channels_encoding.h"
+
+// Channel outputs and PPM centers at the edges of the ranges handled by
+// the frame builders
+static const int16_t boundaryOutputs[] = {
+  -2048, -1536, -1025, -1024, -1023, -1, 0, 1, 1023, 1024, 1025, 1536, 2047
+};
+static const int16_t boundaryCenters[] = {-512, -1, 0, 1, 511};
+
+// Each pass gives every channel another output / center pair, all the
+// pairs are seen after DIM(boundaryOutputs) * DIM(boundaryCenters) passes
+#define BOUNDARY_PASSES (int)(DIM(boundaryOutputs) * DIM(boundaryCenters))
+
+static void setBoundaryChannels(int pass)
+{
+  for (int ch = 0; ch < MAX_OUTPUT_CHANNELS; ch++) {
+    channelOutputs[ch] = boundaryOutputs[(ch + pass) % DIM(boundaryOutputs)];
+    g_model.limitData[ch].ppmCenter = boundaryCenters[(ch + pass / DIM(boundaryOutputs)) % DIM(boundaryCenters)];
+  }
+}
+
+// Channel output with its center, as computed before getChannelOutput()
+static int legacyChannelOutput(int16_t * channels, uint8_t ch, uint8_t index)
+{
+  return channels[index] + 2 * PPM_CH_CENTER(ch) - 2 * PPM_CENTER;
+}
+
+TEST(Pulses, channelCenterHelpers)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  for (int pass = 0; pass < BOUNDARY_PASSES; pass++) {
+    setBoundaryChannels(pass);
+    for (int ch = 0; ch < MAX_OUTPUT_CHANNELS; ch++) {
+      EXPECT_EQ(2 * PPM_CH_CENTER(ch) - 2 * PPM_CENTER, getChannelCenterOffset(ch));
+      EXPECT_EQ(legacyChannelOutput(channelOutputs, ch, ch), getChannelOutput(ch));
+    }
+  }
+}
+
+#if (defined(DSM2) || defined(SBUS)) && defined(HARDWARE_EXTERNAL_MODULE)
+// Decodes a soft serial frame back into bytes: 'wordBits' bits per byte
+// (start, data, parity and stop bits), 'bitLen' half us per bit
+static int decodeSoftSerialFrame(const Dsm2PulsesData * frame, int bitLen,
+                                 int edgeComp, int wordBits, uint8_t * bytes,
+                                 int maxBytes)
+{
+  static uint8_t bits[MAX_PULSES_TRANSITIONS * 16];
+  int bitsCount = 0;
+  uint8_t level = 0;
+
+  for (int i = 0; i < frame->ptr - frame->pulses; i++) {
+    // undo the edge compensation done when building the frame
+    int len = frame->pulses[i] + 1 + ((i & 1) ? -edgeComp : edgeComp);
+    for (int n = (len + bitLen / 2) / bitLen; n > 0 && bitsCount < (int)sizeof(bits); n--) {
+      bits[bitsCount++] = level;
+    }
+    level ^= 1;
+  }
+
+  int count = 0;
+  for (int pos = 0; pos + wordBits <= bitsCount && count < maxBytes; pos += wordBits) {
+    if (bits[pos] != 0) break; // start bit
+    uint8_t byte = 0;
+    for (int bit = 0; bit < 8; bit++) {
+      byte |= bits[pos + 1 + bit] << bit;
+    }
+    bytes[count++] = byte;
+  }
+
+  return count;
+}
+#endif
+
+#if defined(SBUS) && defined(HARDWARE_EXTERNAL_MODULE)
+// SBUS: 8E2, 10us per bit
+static int decodeSbusFrame(const Dsm2PulsesData * frame, uint8_t * bytes, int maxBytes)
+{
+  return decodeSoftSerialFrame(frame, 20, 2, 12, bytes, maxBytes);
+}
+
+// 11 bit channels packer used before packChannels11Bits()
+static uint8_t * legacyPack11Bits(uint8_t * buf, const int * values, uint8_t count)
+{
+  uint32_t bits = 0;
+  uint8_t bitsavailable = 0;
+  for (int i = 0; i < count; i++) {
+    bits |= values[i] << bitsavailable;
+    bitsavailable += 11;
+    while (bitsavailable >= 8) {
+      *buf++ = bits;
+      bits >>= 8;
+      bitsavailable -= 8;
+    }
+  }
+  return buf;
+}
+
+TEST(Pulses, sbusFrame)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  for (int i = 0; i < 16; i++) {
+    channelOutputs[i] = -1024 + 128 * i;
+  }
+  channelOutputs[16] = 500;  // channel 17 flag
+
+  SbusExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+
+  uint8_t bytes[32];
+  ASSERT_EQ(25, decodeSbusFrame(softSerialFrame(), bytes, sizeof(bytes)));
+  EXPECT_EQ(0x0F, bytes[0]);
+  uint16_t values[16];
+  unpackChannels11Bits(&bytes[1], values, 16);
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ(992 + channelOutputs[i] * 8 / 10, values[i]);
+  }
+  EXPECT_EQ(0x01, bytes[23]);
+  EXPECT_EQ(0x00, bytes[24]);
+}
+
+TEST(Pulses, sbusFrameMatchesLegacyEncoder)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  for (int pass = 0; pass < BOUNDARY_PASSES; pass++) {
+    setBoundaryChannels(pass);
+
+    uint8_t expected[25];
+    int values[16];
+    for (int i = 0; i < 16; i++) {
+      values[i] = limit(0, legacyChannelOutput(channelOutputs, i, i) * 8 / 10 + 992, 2047);
+    }
+    expected[0] = 0x0F;
+    legacyPack11Bits(&expected[1], values, 16);
+    expected[23] = (legacyChannelOutput(channelOutputs, 16, 16) > 0 ? 0x01 : 0) |
+                   (legacyChannelOutput(channelOutputs, 17, 17) > 0 ? 0x02 : 0);
+    expected[24] = 0x00;
+
+    SbusExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+
+    uint8_t bytes[32];
+    ASSERT_EQ(25, decodeSbusFrame(softSerialFrame(), bytes, sizeof(bytes)));
+    ASSERT_EQ(0, memcmp(expected, bytes, sizeof(expected))) << "pass " << pass;
+  }
+}
+
+#if defined(MULTIMODULE)
+void sendChannels(uint8_t moduleIdx);
+
+TEST(Pulses, multiChannelsMatchLegacyEncoder)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  for (uint8_t start : {0, 8}) {
+    g_model.moduleData[EXTERNAL_MODULE].channelsStart = start;
+    for (int pass = 0; pass < BOUNDARY_PASSES; pass++) {
+      setBoundaryChannels(pass);
+
+      uint8_t expected[22];
+      int values[16];
+      for (int i = 0; i < 16; i++) {
+        int value = legacyChannelOutput(channelOutputs, start + i, start + i);
+        values[i] = limit(0, value * 800 / 1000 + 1024, 2047);
+      }
+      legacyPack11Bits(expected, values, 16);
+
+      softSerialResetFrame();
+      sendChannels(EXTERNAL_MODULE);
+      sendByteSbus(0x00); // ends the last channels byte
+
+      uint8_t bytes[32];
+      ASSERT_LE(22, decodeSbusFrame(softSerialFrame(), bytes, sizeof(bytes)));
+      ASSERT_EQ(0, memcmp(expected, bytes, sizeof(expected))) << "pass " << pass;
+    }
+  }
+}
+#endif
+
+TEST(Pulses, softSerialDoubleBuffer)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  SbusExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  Dsm2PulsesData * sent = softSerialFrame();
+  Dsm2PulsesData copy;
+  memcpy(&copy, sent, sizeof(copy));
+  SbusExternalDriver.sendPulses(nullptr);
+
+  // the next frame is built in the other buffer
+  channelOutputs[0] = 1024;
+  SbusExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  EXPECT_NE(sent, softSerialFrame());
+  EXPECT_EQ(0, memcmp(&copy, sent, sizeof(copy)));
+  SbusExternalDriver.sendPulses(nullptr);
+  EXPECT_EQ(sent, softSerialFrame());
+}
+
+// Bit by bit encoders used before softSerialPutWord()
+static void refSendLevel(Dsm2PulsesData * frame, uint8_t v, uint8_t edgeComp)
+{
+  if (frame->index & 1)
+    v += edgeComp;
+  else
+    v -= edgeComp;
+  *frame->ptr++ = v - 1;
+  frame->index += 1;
+}
+
+static void refSendByteDsm2(Dsm2PulsesData * frame, uint8_t b, uint8_t bitLen)
+{
+  bool lev = 0;
+  uint8_t len = bitLen;
+  for (uint8_t i = 0; i <= 8; i++) {
+    bool nlev = b & 1;
+    if (lev == nlev) {
+      len += bitLen;
+    }
+    else {
+      refSendLevel(frame, len, 0);
+      len = bitLen;
+      lev = nlev;
+    }
+    b = (b >> 1) | 0x80;
+  }
+  refSendLevel(frame, len, 0);
+}
+
+static void refSendByteSbus(Dsm2PulsesData * frame, uint8_t b)
+{
+  bool lev = 0;
+  uint8_t parity = 1;
+  uint8_t len = 20;
+  for (uint8_t i = 0; i <= 9; i++) {
+    bool nlev = b & 1;
+    parity = parity ^ (uint8_t)nlev;
+    if (lev == nlev) {
+      len += 20;
+    }
+    else {
+      refSendLevel(frame, len, 2);
+      len = 20;
+      lev = nlev;
+    }
+    b = (b >> 1) | 0x80;
+    if (i == 7)
+      b = b ^ parity;
+  }
+  refSendLevel(frame, len + 20, 2);
+}
+
+TEST(Pulses, softSerialWordEncoding)
+{
+  Dsm2PulsesData reference;
+
+  for (int b = 0; b < 256; b++) {
+    for (uint8_t bitLen : {16, 17}) {
+      reference.ptr = reference.pulses;
+      reference.index = 0;
+      refSendByteDsm2(&reference, b, bitLen);
+
+      softSerialResetFrame();
+      softSerialPutWord((1 << 9) | (b << 1), 10, bitLen);
+
+      Dsm2PulsesData * frame = softSerialFrame();
+      ASSERT_EQ(reference.ptr - reference.pulses, frame->ptr - frame->pulses);
+      ASSERT_EQ(0, memcmp(reference.pulses, frame->pulses, (frame->ptr - frame->pulses) * sizeof(pulse_duration_t)));
+    }
+
+    reference.ptr = reference.pulses;
+    reference.index = 0;
+    refSendByteSbus(&reference, b);
+    refSendByteSbus(&reference, ~b);
+
+    softSerialResetFrame();
+    sendByteSbus(b);
+    sendByteSbus(~b);
+
+    Dsm2PulsesData * frame = softSerialFrame();
+    ASSERT_EQ(reference.ptr - reference.pulses, frame->ptr - frame->pulses);
+    ASSERT_EQ(0, memcmp(reference.pulses, frame->pulses, (frame->ptr - frame->pulses) * sizeof(pulse_duration_t)));
+  }
+}
+#endif
+
+#if defined(DSM2) && defined(HARDWARE_EXTERNAL_MODULE)
+// DSM2 and DSMP: 8N1, 125000 and ~117600 bauds
+static int decodeDsmFrame(const Dsm2PulsesData * frame, int bitLen, uint8_t * bytes, int maxBytes)
+{
+  return decodeSoftSerialFrame(frame, bitLen, 0, 10, bytes, maxBytes);
+}
+
+TEST(Pulses, dsm2Frame)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  g_model.header.modelId[EXTERNAL_MODULE] = 5;
+  moduleState[EXTERNAL_MODULE].protocol = PROTOCOL_CHANNELS_DSM2_DSMX;
+  moduleState[EXTERNAL_MODULE].mode = MODULE_MODE_NORMAL;
+
+  uint8_t expected[14];
+  expected[0] = 0x18;
+  expected[1] = 5;
+  for (int i = 0; i < 6; i++) {
+    channelOutputs[i] = -1024 + 400 * i;
+    uint16_t pulse = limit(0, ((channelOutputs[i] * 13) >> 5) + 512, 1023);
+    expected[2 + 2 * i] = (i << 2) | (pulse >> 8);
+    expected[3 + 2 * i] = pulse & 0xff;
+  }
+
+  Dsm2ExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+
+  uint8_t bytes[16];
+  ASSERT_EQ(14, decodeDsmFrame(softSerialFrame(), 16, bytes, sizeof(bytes)));
+  for (int i = 0; i < 14; i++) {
+    EXPECT_EQ(expected[i], bytes[i]);
+  }
+
+  // bind flag in the header
+  moduleState[EXTERNAL_MODULE].protocol = PROTOCOL_CHANNELS_DSM2_LP45;
+  moduleState[EXTERNAL_MODULE].mode = MODULE_MODE_BIND;
+  Dsm2ExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  ASSERT_EQ(14, decodeDsmFrame(softSerialFrame(), 16, bytes, sizeof(bytes)));
+  EXPECT_EQ(0x80, bytes[0]);
+
+  moduleState[EXTERNAL_MODULE].mode = MODULE_MODE_NORMAL;
+}
+
+TEST(Pulses, dsmpFrame)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  for (int i = 0; i < 8; i++) {
+    channelOutputs[i] = -1024 + 256 * i;
+  }
+  moduleState[EXTERNAL_MODULE].counter = 100;
+
+  // a frame built in bind mode restarts the sequence
+  moduleState[EXTERNAL_MODULE].mode = MODULE_MODE_BIND;
+  DsmpExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+
+  uint8_t bytes[32];
+  DsmpExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  ASSERT_EQ(6, decodeDsmFrame(softSerialFrame(), 17, bytes, sizeof(bytes)));
+  const uint8_t bind[] = {0xAA, 0x00, 0xC0, 7, 12, 1};
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(bind[i], bytes[i]);
+  }
+
+  // then one setup frame in normal mode
+  moduleState[EXTERNAL_MODULE].mode = MODULE_MODE_NORMAL;
+  DsmpExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  ASSERT_EQ(6, decodeDsmFrame(softSerialFrame(), 17, bytes, sizeof(bytes)));
+  const uint8_t setup[] = {0xAA, 0x00, 0x00, 7, 8, 1};
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(setup[i], bytes[i]);
+  }
+
+  // followed by channel frames: 8th channel and unused slots first,
+  // then channels 1 to 7
+  for (uint8_t pass : {2, 1}) {
+    DsmpExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+    ASSERT_EQ(16, decodeDsmFrame(softSerialFrame(), 17, bytes, sizeof(bytes)));
+    EXPECT_EQ(0xAA, bytes[0]);
+    EXPECT_EQ(pass, bytes[1]);
+    for (int i = 0; i < 7; i++) {
+      int channel = (pass == 2 ? 7 : 0) + i;
+      uint16_t pulse = 0xFFFF;
+      if (channel < 8) {
+        pulse = limit(0, ((channelOutputs[channel] * 13) >> 5) + 512, 1023) |
+                (channel << 10);
+      }
+      EXPECT_EQ(pulse >> 8, bytes[2 + 2 * i]);
+      EXPECT_EQ(pulse & 0xFF, bytes[3 + 2 * i]);
+    }
+  }
+}
+#endif
+
+#if defined(PPM) && defined(HARDWARE_EXTERNAL_MODULE)
+TEST(Pulses, ppmDoubleBuffer)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  PpmExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  auto sent = extmodulePulsesData.ppm.frame();
+  EXPECT_EQ(9, sent->ptr - sent->pulses);
+  PpmExternalDriver.sendPulses(nullptr);
+
+  // the frame sent is left untouched while the next one is built
+  channelOutputs[0] = 1024;
+  PpmExternalDriver.setupPulses(nullptr, channelOutputs, 16);
+  auto next = extmodulePulsesData.ppm.frame();
+  EXPECT_NE(sent, next);
+  EXPECT_NE(sent->pulses[0], next->pulses[0]);
+  PpmExternalDriver.sendPulses(nullptr);
+  EXPECT_EQ(sent, extmodulePulsesData.ppm.frame());
+}
+#endif
+
+#if defined(GHOST)
+uint8_t createGhostChannelsFrame(uint8_t * frame, int16_t * pulses, bool raw12bits);
+
+// Ghost channels frame as built before getChannelCenterOffset()
+static uint8_t legacyGhostChannelsFrame(uint8_t * frame, int16_t * pulses, bool raw12bits,
+                                        uint8_t type, uint8_t ghostUpper4Offset)
+{
+  uint8_t * buf = frame;
+  *buf++ = getGhostModuleAddr();
+  *buf++ = GHST_UL_RC_CHANS_SIZE;
+  uint8_t * crc_start = buf;
+  *buf++ = type;
+
+  uint32_t bits = 0;
+  uint8_t bitsavailable = 0;
+  for (int i = 0; i < 4; i++) {
+    uint32_t value;
+    if (raw12bits) {
+      value = limit(0, (1024 + legacyChannelOutput(pulses, i, i)) << 1, 0xFFF);
+    }
+    else {
+      value = limit(0, GHST_RC_CTR_VAL_12BIT + ((legacyChannelOutput(pulses, i, i) << 3) / 5), 2 * GHST_RC_CTR_VAL_12BIT);
+    }
+    bits |= value << bitsavailable;
+    bitsavailable += GHST_CH_BITS_12;
+    while (bitsavailable >= 8) {
+      *buf++ = bits;
+      bits >>= 8;
+      bitsavailable -= 8;
+    }
+  }
+
+  for (int i = 4; i < 8; ++i) {
+    uint8_t channelIndex = i + ghostUpper4Offset;
+    int value = legacyChannelOutput(pulses, channelIndex, channelIndex);
+    if (raw12bits) {
+      *buf++ = limit(0, 128 + (value >> 3), 0xFF);
+    }
+    else {
+      *buf++ = limit(0, GHST_RC_CTR_VAL_8BIT + ((value >> 1) / 5), 2 * GHST_RC_CTR_VAL_8BIT);
+    }
+  }
+
+  *buf++ = crc8(crc_start, GHST_UL_RC_CHANS_SIZE - 1);
+  return buf - frame;
+}
+
+TEST(Pulses, ghostChannelsFrameMatchesLegacyEncoder)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  for (bool raw12bits : {false, true}) {
+    for (int pass = 0; pass < BOUNDARY_PASSES; pass++) {
+      setBoundaryChannels(pass);
+
+      // the frames cycle through channels 5-8, 9-12 and 13-16
+      for (int frame = 0; frame < 3; frame++) {
+        uint8_t bytes[GHST_UL_RC_CHANS_SIZE + 2];
+        ASSERT_EQ(sizeof(bytes), createGhostChannelsFrame(bytes, channelOutputs, raw12bits));
+        uint8_t type = bytes[2];
+        ASSERT_EQ(raw12bits ? GHST_UL_RC_CHANS_HS4_12_5TO8 : GHST_UL_RC_CHANS_HS4_5TO8, type & 0xF0);
+
+        uint8_t expected[GHST_UL_RC_CHANS_SIZE + 2];
+        ASSERT_EQ(sizeof(expected), legacyGhostChannelsFrame(expected, channelOutputs, raw12bits, type, 4 * (type & 0x0F)));
+        ASSERT_EQ(0, memcmp(expected, bytes, sizeof(expected))) << "pass " << pass;
+      }
+    }
+  }
+}
+#endif
+
+#if defined(PXX1) || defined(PXX2)
+// PXX channels are sent in pairs, 12 bits each
+static uint8_t * legacyPxxPulsesValues(uint8_t * buf, uint16_t low, uint16_t high)
+{
+  *buf++ = low;
+  *buf++ = ((low >> 8) & 0x0F) | (high << 4);
+  *buf++ = high >> 4;
+  return buf;
+}
+#endif
+
+#if defined(PXX2)
+class Pxx2ChannelsFrame: public Pxx2Pulses {
+  public:
+    void build(uint8_t module, int16_t * channels, uint8_t nChannels)
+    {
+      initFrame();
+      setupChannelsFrame(module, channels, nChannels);
+    }
+};
+
+TEST(Pulses, pxx2ChannelsMatchLegacyEncoder)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  Pxx2ChannelsFrame pxx2;
+  g_model.moduleData[EXTERNAL_MODULE].channelsCount = 8; // 16 channels
+
+  for (uint8_t start : {0, 8}) {
+    g_model.moduleData[EXTERNAL_MODULE].channelsStart = start;
+    for (int pass = 0; pass < BOUNDARY_PASSES; pass++) {
+      setBoundaryChannels(pass);
+
+      uint8_t expected[24];
+      uint8_t * buf = expected;
+      uint16_t pulseValueLow = 0;
+      for (int i = 0; i < 16; i++) {
+        int value = legacyChannelOutput(&channelOutputs[start], start + i, i);
+        uint16_t pulseValue = limit(1, (value * 512 / 682) + 1024, 2046);
+        if (i & 1)
+          buf = legacyPxxPulsesValues(buf, pulseValueLow, pulseValue);
+        else
+          pulseValueLow = pulseValue;
+      }
+
+      pxx2.build(EXTERNAL_MODULE, &channelOutputs[start], 16);
+
+      // head, length, type, flags, then the channels
+      ASSERT_EQ(6 + sizeof(expected), pxx2.getSize());
+      ASSERT_EQ(0, memcmp(expected, pxx2.getData() + 6, sizeof(expected))) << "pass " << pass;
+    }
+  }
+}
+#endif
+
+#if defined(PXX1)
+class Pxx1ChannelsFrame: public UartPxx1Pulses {
+  public:
+    void build(uint8_t module, uint8_t sendUpperChannels)
+    {
+      initFrame(0);
+      addChannels(module, 0, sendUpperChannels);
+    }
+};
+
+TEST(Pulses, pxx1ChannelsMatchLegacyEncoder)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  Pxx1ChannelsFrame pxx1;
+
+  for (int8_t channelsCount : {-4, 0, 8}) {
+    g_model.moduleData[EXTERNAL_MODULE].channelsCount = channelsCount;
+    for (uint8_t start : {0, 8}) {
+      g_model.moduleData[EXTERNAL_MODULE].channelsStart = start;
+      for (uint8_t sendUpperChannels : {0, 8}) {
+        for (int pass = 0; pass < BOUNDARY_PASSES; pass++) {
+          setBoundaryChannels(pass);
+
+          uint8_t raw[12];
+          uint8_t * buf = raw;
+          uint16_t pulseValueLow = 0;
+          for (int i = 0; i < 8; i++) {
+            uint16_t pulseValue;
+            if (i < sendUpperChannels) {
+              int channel = 8 + start + i;
+              int value = legacyChannelOutput(channelOutputs, channel, channel);
+              pulseValue = limit(2049, (value * 512 / 682) + 3072, 4094);
+            }
+            else if (i < 8 + channelsCount) {
+              int channel = start + i;
+              int value = legacyChannelOutput(channelOutputs, channel, channel);
+              pulseValue = limit(1, (value * 512 / 682) + 1024, 2046);
+            }
+            else {
+              pulseValue = 1024;
+            }
+            if (i & 1)
+              buf = legacyPxxPulsesValues(buf, pulseValueLow, pulseValue);
+            else
+              pulseValueLow = pulseValue;
+          }
+
+          // UART frames escape 0x7E and 0x7D
+          uint8_t expected[2 * sizeof(raw)];
+          uint8_t size = 0;
+          for (uint8_t byte : raw) {
+            if (byte == 0x7E || byte == 0x7D) {
+              expected[size++] = 0x7D;
+              expected[size++] = byte ^ 0x20;
+            }
+            else {
+              expected[size++] = byte;
+            }
+          }
+
+          pxx1.build(EXTERNAL_MODULE, sendUpperChannels);
+          ASSERT_EQ(size, pxx1.getSize());
+          ASSERT_EQ(0, memcmp(expected, pxx1.getData(), size)) << "pass " << pass;
+        }
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "gtests.h"
+#include "sbus.h"
+#include "pulses/channels_encoding.h"
+
+static const uint8_t * sbusStream;
+static uint32_t sbusStreamPos;
+static uint32_t sbusStreamEnd;
+
+static int sbusStreamGetByte(uint8_t * byte)
+{
+  if (sbusStreamPos >= sbusStreamEnd)
+    return 0;
+  *byte = sbusStream[sbusStreamPos++];
+  return 1;
+}
+
+// Feeds the stream in chunks of varying size, as received between two mixer runs
+static void feedSbusStream(const uint8_t * data, uint32_t len)
+{
+  static const uint8_t chunks[] = { 7, 1, 13, 3, 25, 2, 31, 9 };
+
+  sbusSetGetByte(sbusStreamGetByte);
+  sbusStream = data;
+  sbusStreamPos = 0;
+  for (uint32_t i = 0; sbusStreamPos < len; i++) {
+    sbusStreamEnd = sbusStreamPos + chunks[i % sizeof(chunks)];
+    if (sbusStreamEnd > len)
+      sbusStreamEnd = len;
+    processSbusInput();
+  }
+  sbusSetGetByte(nullptr);
+}
+
+static uint8_t * buildSbusFrame(uint8_t * buf, const uint16_t * values, uint8_t flags)
+{
+  *buf++ = 0x0F;
+  buf = packChannels11Bits(buf, values, 16);
+  *buf++ = flags;
+  *buf++ = 0x00;
+  return buf;
+}
+
+TEST(Sbus, unpackChannels)
+{
+  uint16_t values[16];
+  for (int i = 0; i < 16; i++) {
+    values[i] = (i * 0x2A5 + 0x1F) & 0x7FF;
+  }
+
+  uint8_t buf[22];
+  packChannels11Bits(buf, values, 16);
+
+  uint16_t result[16];
+  unpackChannels11Bits(buf, result, 16);
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ(values[i], result[i]);
+  }
+}
+
+TEST(Sbus, streamWithGarbage)
+{
+  uint16_t values[16];
+  uint16_t lastValues[16];
+  uint16_t failsafe[16];
+  for (int i = 0; i < 16; i++) {
+    values[i] = 172 + i * 100;
+    lastValues[i] = 1811 - i * 75;
+    failsafe[i] = 0x3E0;
+  }
+
+  uint8_t stream[256];
+  uint8_t * p = stream;
+
+  // garbage, including start and end bytes
+  static const uint8_t garbage[] = { 0x00, 0x0F, 0x55, 0x0F, 0x00, 0xFF, 0x0F };
+  memcpy(p, garbage, sizeof(garbage));
+  p += sizeof(garbage);
+
+  p = buildSbusFrame(p, values, 0x00);
+  p = buildSbusFrame(p, failsafe, 1 << 3);  // failsafe frame, ignored
+
+  // truncated frame
+  uint8_t truncated[SBUS_FRAME_SIZE];
+  buildSbusFrame(truncated, failsafe, 0x00);
+  memcpy(p, truncated, 10);
+  p += 10;
+
+  // last frame, with its own values
+  p = buildSbusFrame(p, lastValues, 0x00);
+
+  memclear(ppmInput, sizeof(ppmInput));
+  ppmInputValidityTimer = 0;
+
+  feedSbusStream(stream, p - stream);
+
+  EXPECT_NE(0, ppmInputValidityTimer);
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ((lastValues[i] - 0x3E0) * 5 / 8, ppmInput[i]);
+  }
+}
+
+TEST(Sbus, frameDecodedOnLastByte)
+{
+  uint16_t values[16];
+  for (int i = 0; i < 16; i++) {
+    values[i] = 2000 - i * 50;
+  }
+
+  uint8_t frame[SBUS_FRAME_SIZE];
+  buildSbusFrame(frame, values, 0x00);
+
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusSetGetByte(sbusStreamGetByte);
+  sbusStream = frame;
+  sbusStreamPos = 0;
+
+  sbusStreamEnd = SBUS_FRAME_SIZE - 1;
+  processSbusInput();
+  EXPECT_EQ(0, ppmInput[0]);
+
+  sbusStreamEnd = SBUS_FRAME_SIZE;
+  processSbusInput();
+  sbusSetGetByte(nullptr);
+
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ((values[i] - 0x3E0) * 5 / 8, ppmInput[i]);
+  }
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "gtests.h"
+#include "location.h"
+
+#if defined(SDCARD)
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <strings.h>
+
+#define LIST_TEST_PATH "/LISTTEST"
+
+#if !defined(COLORLCD)
+
+class SdListFilesTest : public OpenTxTest
+{
+  protected:
+    std::vector<std::string> names;
+
+    void SetUp() override
+    {
+      OpenTxTest::SetUp();
+      simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+      sdCheckAndCreateDirectory(LIST_TEST_PATH);
+      popupMenuItemsCount = 0;
+      popupMenuOffset = 0;
+    }
+
+    void TearDown() override
+    {
+      for (auto & name: names) {
+        f_unlink((LIST_TEST_PATH "/" + name + SOUNDS_EXT).c_str());
+      }
+      f_unlink(LIST_TEST_PATH "/skipped.txt");
+      f_unlink(LIST_TEST_PATH);
+      popupMenuItemsCount = 0;
+      popupMenuOffset = 0;
+      simuFatfsSetPaths("", "");
+    }
+
+    void createFiles(unsigned count)
+    {
+      for (unsigned i = 0; i < count; i++) {
+        char name[16];
+        // not created in name order
+        sprintf(name, "snd%03u", (i * 37) % count);
+        names.push_back(name);
+        FIL file;
+        std::string path = LIST_TEST_PATH "/" + names.back() + SOUNDS_EXT;
+        ASSERT_EQ(FR_OK, f_open(&file, path.c_str(), FA_CREATE_ALWAYS | FA_WRITE));
+        f_close(&file);
+      }
+      FIL file;
+      ASSERT_EQ(FR_OK, f_open(&file, LIST_TEST_PATH "/skipped.txt", FA_CREATE_ALWAYS | FA_WRITE));
+      f_close(&file);
+      std::sort(names.begin(), names.end());
+    }
+
+    void checkWindow()
+    {
+      for (uint8_t i = 0; i < MENU_MAX_DISPLAY_LINES; i++) {
+        unsigned index = popupMenuOffset + i;
+        EXPECT_STREQ(index < names.size() ? names[index].c_str() : "", popupMenuItems[i]);
+      }
+    }
+};
+
+TEST_F(SdListFilesTest, scrollThroughList)
+{
+  createFiles(100);
+
+  EXPECT_TRUE(sdListFiles(LIST_TEST_PATH, SOUNDS_EXT, 8, nullptr));
+  EXPECT_EQ(100, popupMenuItemsCount);
+  checkWindow();
+
+  // the snapshot is used while the popup is open, even if the directory changes
+  f_unlink((LIST_TEST_PATH "/" + names[0] + SOUNDS_EXT).c_str());
+  for (popupMenuOffset = 1; popupMenuOffset <= names.size() - MENU_MAX_DISPLAY_LINES; popupMenuOffset++) {
+    EXPECT_TRUE(sdListFiles(LIST_TEST_PATH, SOUNDS_EXT, 8, nullptr));
+    EXPECT_EQ(100, popupMenuItemsCount);
+    checkWindow();
+  }
+
+  // a new list reads the directory again, and starts at the selection
+  names.erase(names.begin());
+  popupMenuItemsCount = 0;
+  EXPECT_TRUE(sdListFiles(LIST_TEST_PATH, SOUNDS_EXT, 8, "snd050"));
+  EXPECT_EQ(99, popupMenuItemsCount);
+  EXPECT_EQ(49, popupMenuOffset);
+  checkWindow();
+}
+
+TEST_F(SdListFilesTest, noneItem)
+{
+  createFiles(10);
+
+  EXPECT_TRUE(sdListFiles(LIST_TEST_PATH, SOUNDS_EXT, 8, "", LIST_NONE_SD_FILE));
+  EXPECT_EQ(11, popupMenuItemsCount);
+  EXPECT_EQ(0, popupMenuOffset);
+  EXPECT_STREQ("---", popupMenuItems[0]);
+  EXPECT_STREQ(names[0].c_str(), popupMenuItems[1]);
+}
+
+#endif // !COLORLCD
+
+#if FF_USE_FASTSEEK
+TEST(SdFastSeek, mapsPool)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+
+  FIL file;
+  UINT written;
+  ASSERT_EQ(FR_OK, f_open(&file, "/fastseek.bin", FA_CREATE_ALWAYS | FA_WRITE));
+  for (uint16_t i = 0; i < 1000; i++) {
+    f_write(&file, &i, sizeof(i), &written);
+  }
+  f_close(&file);
+
+  FIL files[3];
+  for (auto & f: files) {
+    ASSERT_EQ(FR_OK, f_open(&f, "/fastseek.bin", FA_OPEN_EXISTING | FA_READ));
+  }
+
+  EXPECT_TRUE(sdEnableFastSeek(&files[0]));
+  EXPECT_TRUE(sdEnableFastSeek(&files[1]));
+  // the pool is empty
+  EXPECT_FALSE(sdEnableFastSeek(&files[2]));
+  sdDisableFastSeek(&files[0]);
+  EXPECT_TRUE(sdEnableFastSeek(&files[2]));
+
+  // seeks with a map read the same data
+  uint16_t value;
+  UINT read;
+  for (uint16_t i: {900, 10, 500}) {
+    EXPECT_EQ(FR_OK, f_lseek(&files[2], i * sizeof(value)));
+    EXPECT_EQ(FR_OK, f_read(&files[2], &value, sizeof(value), &read));
+    EXPECT_EQ(i, value);
+  }
+
+  // and do not go past the end
+  EXPECT_EQ(FR_OK, f_lseek(&files[2], 5000));
+  EXPECT_EQ(2000, f_tell(&files[2]));
+
+  for (auto & f: files) {
+    sdDisableFastSeek(&f);
+    f_close(&f);
+  }
+  f_unlink("/fastseek.bin");
+  simuFatfsSetPaths("", "");
+}
+#endif
+
+#endif
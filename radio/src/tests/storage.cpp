@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "model_slots.h"
+
+#if defined(SDCARD_YAML) && !defined(STORAGE_MODELSLIST)
+#define MODEL_PATH(idx)  MODELS_PATH "/model" idx YAML_EXT
+
+static void writeFile(const char * path, const char * content)
+{
+  FIL file;
+  UINT written;
+  ASSERT_EQ(FR_OK, f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE));
+  f_write(&file, content, strlen(content), &written);
+  f_close(&file);
+}
+
+static bool fileExists(const char * path)
+{
+  FILINFO fno;
+  return f_stat(path, &fno) == FR_OK;
+}
+
+#define EXPECT_MODEL_NAME(idx, name) do { \
+    ModelHeader header; \
+    memclear(&header, sizeof(header)); \
+    loadModelHeader(idx, &header); \
+    EXPECT_STRNEQ(name, header.name); \
+  } while (0)
+
+typedef ModelSlotsTest StorageJournalTest;
+
+TEST_F(StorageJournalTest, saveLeavesNoTemporaryFile)
+{
+  writeModelSlot(0, "First");
+  writeModelSlot(0, "Second");
+  EXPECT_FALSE(fileExists(MODEL_PATH("00") ".tmp"));
+  EXPECT_MODEL_NAME(0, "Second");
+}
+
+TEST_F(StorageJournalTest, uncommittedSaveDropped)
+{
+  writeModelSlot(0, "Saved");
+  // power loss while writing the new content
+  writeFile(MODEL_PATH("00") ".tmp", "header:\n  name: \"Hal");
+
+  recoverPendingWrites();
+  EXPECT_FALSE(fileExists(MODEL_PATH("00") ".tmp"));
+  EXPECT_MODEL_NAME(0, "Saved");
+}
+
+TEST_F(StorageJournalTest, committedSaveCompleted)
+{
+  writeModelSlot(0, "Saved");
+  // power loss once the old file is removed
+  ASSERT_EQ(FR_OK, f_rename(MODEL_PATH("00"), MODEL_PATH("00") ".tmp"));
+
+  recoverPendingWrites();
+  EXPECT_FALSE(fileExists(MODEL_PATH("00") ".tmp"));
+  EXPECT_MODEL_NAME(0, "Saved");
+}
+
+TEST_F(StorageJournalTest, swapModels)
+{
+  writeModelSlot(0, "First");
+  writeModelSlot(1, "Second");
+
+  swapModels(0, 1);
+  EXPECT_MODEL_NAME(0, "Second");
+  EXPECT_MODEL_NAME(1, "First");
+
+  // with an empty slot, either way
+  swapModels(1, 2);
+  EXPECT_FALSE(fileExists(MODEL_PATH("01")));
+  EXPECT_MODEL_NAME(2, "First");
+  swapModels(1, 0);
+  EXPECT_FALSE(fileExists(MODEL_PATH("00")));
+  EXPECT_MODEL_NAME(1, "Second");
+}
+
+TEST_F(StorageJournalTest, interruptedSwapCompleted)
+{
+  writeModelSlot(0, "First");
+  writeModelSlot(1, "Second");
+  writeModelSlot(2, "Third");
+  writeModelSlot(3, "Fourth");
+
+  // power loss after the first rename of swapModels(0, 1)
+  ASSERT_EQ(FR_OK, f_rename(MODEL_PATH("00"), MODELS_PATH "/model00-01.swp"));
+  // power loss after the second rename of swapModels(2, 3)
+  ASSERT_EQ(FR_OK, f_rename(MODEL_PATH("02"), MODELS_PATH "/model02-03.swp"));
+  ASSERT_EQ(FR_OK, f_rename(MODEL_PATH("03"), MODEL_PATH("02")));
+
+  recoverPendingWrites();
+  EXPECT_FALSE(fileExists(MODELS_PATH "/model00-01.swp"));
+  EXPECT_FALSE(fileExists(MODELS_PATH "/model02-03.swp"));
+  EXPECT_MODEL_NAME(0, "Second");
+  EXPECT_MODEL_NAME(1, "First");
+  EXPECT_MODEL_NAME(2, "Fourth");
+  EXPECT_MODEL_NAME(3, "Third");
+}
+
+#if defined(STORAGE_TASK)
+static void editModel(const char * name)
+{
+  memclear(g_model.header.name, sizeof(g_model.header.name));
+  strncpy(g_model.header.name, name, sizeof(g_model.header.name));
+  storageDirty(EE_MODEL);
+}
+
+// reads the file directly, loadModelHeader() would write the pending copy
+static bool modelFileContains(const char * path, const char * str)
+{
+  char buf[256];
+  FIL file;
+  UINT read = 0;
+  if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    return false;
+  f_read(&file, buf, sizeof(buf) - 1, &read);
+  f_close(&file);
+  buf[read] = '\0';
+  return strstr(buf, str) != nullptr;
+}
+
+TEST_F(StorageJournalTest, backgroundWriteUsesCopy)
+{
+  writeModelSlot(0, "Saved");
+
+  editModel("Copied");
+  storageCheck(false);
+  EXPECT_EQ(0, storageDirtyMsk & EE_MODEL);
+  EXPECT_TRUE(modelFileContains(MODEL_PATH("00"), "Saved"));
+
+  // edited again while the storage task has not run yet
+  editModel("Edited");
+  storageCheck(false);
+  EXPECT_EQ(EE_MODEL, storageDirtyMsk & EE_MODEL);
+
+  storageFlushPending();
+  EXPECT_MODEL_NAME(0, "Copied");
+
+  storageCheck(false);
+  storageFlushPending();
+  EXPECT_MODEL_NAME(0, "Edited");
+}
+
+TEST_F(StorageJournalTest, immediateWriteFlushesCopy)
+{
+  writeModelSlot(0, "Saved");
+  editModel("Copied");
+  storageCheck(false);
+
+  // the model is changed before the storage task has run
+  editModel("Other");
+  g_eeGeneral.currModel = 1;
+  storageCheck(true);
+  EXPECT_MODEL_NAME(0, "Copied");
+  EXPECT_MODEL_NAME(1, "Other");
+
+  // nothing left for the storage task
+  storageFlushPending();
+  EXPECT_MODEL_NAME(0, "Copied");
+}
+
+TEST_F(StorageJournalTest, readingModelFlushesCopy)
+{
+  writeModelSlot(0, "Saved");
+  editModel("Copied");
+  storageCheck(false);
+
+  // the menus read the model before the storage task has run
+  EXPECT_MODEL_NAME(0, "Copied");
+  EXPECT_TRUE(modelFileContains(MODEL_PATH("00"), "Copied"));
+}
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include <string>
+#include "gtests.h"
+
+#if defined(SDCARD_YAML)
+#include "storage/yaml/yaml_datastructs.h"
+#include "storage/yaml/yaml_tree_walker.h"
+
+static bool appendToString(void* opaque, const char* str, size_t len)
+{
+  ((std::string*)opaque)->append(str, len);
+  return true;
+}
+
+static std::string generateModelYaml()
+{
+  std::string yaml;
+  YamlTreeWalker tree;
+  tree.reset(get_modeldata_nodes(), (uint8_t*)&g_model);
+  tree.generate(appendToString, &yaml);
+  return yaml;
+}
+
+// feed the parser the same way readYamlFile() does,
+// and return the number of bytes read
+static size_t parseModelYaml(const std::string& yaml, const YamlNode* nodes,
+                             uint8_t* data, size_t size)
+{
+  YamlTreeWalker tree;
+  tree.reset(nodes, data);
+  memset(data, 0, size);
+
+  YamlParser yp;
+  yp.init(YamlTreeWalker::get_parser_calls(), &tree);
+
+  size_t pos = 0;
+  while (pos < yaml.size()) {
+    size_t len = yaml.size() - pos;
+    if (len > 32) len = 32;
+    pos += len;
+    if (pos == yaml.size()) yp.set_eof();
+    if (yp.parse(yaml.data() + pos - len, len) != YamlParser::CONTINUE_PARSING)
+      break;
+  }
+  return pos;
+}
+
+static void setTestModel()
+{
+  strcpy(g_model.header.name, "Partial");
+  g_model.timers[0].mode = TMRMODE_ON;
+  g_model.timers[0].start = 300;
+  g_model.timers[1].mode = TMRMODE_ON;
+  g_model.timers[1].start = 120;
+  strncpy(g_model.timers[1].name, "T2", sizeof(g_model.timers[1].name));
+  for (uint8_t i = 0; i < MAX_OUTPUT_CHANNELS; i++) {
+    g_model.limitData[i].offset = i;
+  }
+}
+
+TEST(Yaml, partialModelMatchesFullRead)
+{
+  MODEL_RESET();
+  setModelDefaults();
+  setTestModel();
+  std::string yaml = generateModelYaml();
+
+  static ModelData full;
+  EXPECT_EQ(yaml.size(), parseModelYaml(yaml, get_modeldata_nodes(),
+                                        (uint8_t*)&full, sizeof(full)));
+
+  PartialModel partial;
+  size_t read = parseModelYaml(yaml, get_partialmodel_nodes(),
+                               (uint8_t*)&partial, sizeof(partial));
+
+  EXPECT_STRNEQ("Partial", partial.header.name);
+  EXPECT_EQ(0, memcmp(&partial.header, &full.header, sizeof(partial.header)));
+  EXPECT_EQ(0, memcmp(partial.timers, full.timers, sizeof(partial.timers)));
+
+  // nothing past the timers was read
+  EXPECT_LT(read, yaml.find("limitData"));
+}
+
+TEST(Yaml, partialModelWithoutTimers)
+{
+  MODEL_RESET();
+  setModelDefaults();
+  setTestModel();
+  memclear(g_model.timers, sizeof(g_model.timers));
+  std::string yaml = generateModelYaml();
+
+  static ModelData full;
+  parseModelYaml(yaml, get_modeldata_nodes(), (uint8_t*)&full, sizeof(full));
+
+  PartialModel partial;
+  parseModelYaml(yaml, get_partialmodel_nodes(), (uint8_t*)&partial,
+                 sizeof(partial));
+
+  EXPECT_EQ(0, memcmp(&partial.header, &full.header, sizeof(partial.header)));
+  EXPECT_EQ(0, memcmp(partial.timers, full.timers, sizeof(partial.timers)));
+}
+
+TEST(Yaml, partialModelRfMatchesFullRead)
+{
+  MODEL_RESET();
+  setModelDefaults();
+  setTestModel();
+  g_model.header.modelId[EXTERNAL_MODULE] = 9;
+  g_model.moduleData[EXTERNAL_MODULE].type = MODULE_TYPE_XJT_PXX1;
+  g_model.moduleData[EXTERNAL_MODULE].subType = MODULE_SUBTYPE_PXX1_ACCST_D8;
+  std::string yaml = generateModelYaml();
+
+  static ModelData full;
+  parseModelYaml(yaml, get_modeldata_nodes(), (uint8_t*)&full, sizeof(full));
+
+  PartialModelRf partial;
+  size_t read = parseModelYaml(yaml, get_partialmodelrf_nodes(),
+                               (uint8_t*)&partial, sizeof(partial));
+
+  EXPECT_EQ(9, partial.header.modelId[EXTERNAL_MODULE]);
+  EXPECT_EQ(0, memcmp(&partial.header, &full.header, sizeof(partial.header)));
+  EXPECT_EQ(0, memcmp(partial.moduleData, full.moduleData,
+                      sizeof(partial.moduleData)));
+
+  // reading stops at the first top level node after the modules
+  size_t next = yaml.find("\nmoduleData:");
+  do {
+    next = yaml.find('\n', next + 1);
+  } while (next != std::string::npos && yaml[next + 1] == ' ');
+  ASSERT_NE(std::string::npos, next);
+  EXPECT_LT(read, yaml.find('\n', next + 1) + 32);
+}
+
+TEST(Yaml, unknownNodesSkipped)
+{
+  MODEL_RESET();
+  setModelDefaults();
+  setTestModel();
+  std::string yaml = generateModelYaml();
+
+  // values too long for the parser buffer are fine
+  // as long as they belong to nodes which are not read
+  std::string unknown =
+      "unknownValue: \"" + std::string(2 * MAX_STR, 'x') + "\"\r\n"
+      "unknownNode: \r\n"
+      "   sub: \r\n"
+      "    -\r\n"
+      "      value: \"" + std::string(2 * MAX_STR, 'x') + "\"\r\n";
+  size_t pos = yaml.find("header:");
+  yaml.insert(pos, unknown);
+
+  static ModelData full;
+  EXPECT_EQ(yaml.size(), parseModelYaml(yaml, get_modeldata_nodes(),
+                                        (uint8_t*)&full, sizeof(full)));
+  EXPECT_STRNEQ("Partial", full.header.name);
+  EXPECT_EQ(0, memcmp(full.limitData, g_model.limitData,
+                      sizeof(g_model.limitData)));
+}
+#endif
@@ -53,7 +53,11 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK	0
+#if defined(BOOT)
+  #define FF_USE_FASTSEEK	0
+#else
+  #define FF_USE_FASTSEEK	1
+#endif
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
@@ -198,6 +198,7 @@ LUALIB_API char *(luaL_buffinitsize) (lua_State *L, luaL_Buffer *B, size_t sz);
 typedef struct luaL_Stream {
 #if defined(USE_FATFS)
   FIL f;
+  unsigned char fastseek;  /* cluster map already asked for (see io_seek) */
 #else
   FILE *f;  /* stream (NULL for incompletely created streams) */
   lua_CFunction closef;  /* to close stream (NULL for closed streams) */
@@ -30,6 +30,20 @@
 
 #if defined(USE_FATFS)
   #define FILE FIL
+  #if FF_USE_FASTSEEK
+    #include <stdbool.h>
+    /* cluster link maps, provided by the firmware (sdcard.cpp) */
+    extern bool sdEnableFastSeek(FIL *f);
+    extern void sdDisableFastSeek(FIL *f);
+  #else
+    #define sdDisableFastSeek(f)
+  #endif
+  #if defined(STORAGE_TASK)
+    /* settings still written by the storage task (sdcard_common.cpp) */
+    extern void storageFlushPending(void);
+  #else
+    #define storageFlushPending()
+  #endif
 #endif
 
 #if !defined(lua_checkmode)
@@ -193,7 +207,9 @@ static int aux_close (lua_State *L) {
 
 static int io_close (lua_State *L) {
 #if defined(USE_FATFS)
-  f_close(tofile(L));
+  FILE *f = tofile(L);
+  sdDisableFastSeek(f);
+  f_close(f);
   return 0;
 #else
   if (lua_isnone(L, 1))  /* no argument? */
@@ -209,6 +225,7 @@ static int f_gc (lua_State *L) {
   if (!isclosed(p) && p->f != NULL)
     aux_close(L);  /* ignore closed and incompletely open files */
 #endif
+  sdDisableFastSeek(tofile(L));
   f_close(tofile(L));  // no need to check if file was already closed (fatfs will not close it if p->f->fs is 0)
   return 0;
 }
@@ -226,7 +243,9 @@ static int io_fclose (lua_State *L) {
 
 static LStream *newfile (lua_State *L) {
   LStream *p = newprefile(L);
-#if !defined(USE_FATFS)
+#if defined(USE_FATFS)
+  p->fastseek = 0;
+#else
   p->f = NULL;
   p->closef = &io_fclose;
 #endif
@@ -252,6 +271,7 @@ static int io_open (lua_State *L) {
     mode = FA_WRITE | FA_CREATE_ALWAYS;     // always create file and truncate it
   else if (*md == 'a')
     mode = FA_WRITE | FA_OPEN_ALWAYS;       // always open file (create it if necessary) 
+  storageFlushPending();
   FRESULT result = f_open(&p->f, filename, mode);
   if (result == FR_OK) {
     if (*md == 'a')
@@ -640,6 +660,15 @@ static int f_flush (lua_State *L) {
 static int io_seek (lua_State *L) {
   FILE *f = tofile(L);
   lua_Unsigned offset = luaL_checkunsigned(L, 2);
+#if FF_USE_FASTSEEK
+  /* files only read get a cluster map at their first seek, if one is left;
+     it is asked for once only, as building it walks the whole FAT chain */
+  LStream *p = tolstream(L);
+  if (!p->fastseek && !(f->flag & FA_WRITE)) {
+    p->fastseek = 1;
+    sdEnableFastSeek(f);
+  }
+#endif
   lua_pushinteger(L, f_lseek(f, offset));
   return 1;
 }